@@ -36,9 +36,19 @@ extern "C" {
 #include "debug_print.h"
 #endif
 
+#include "I2cBus.h"
 #include "RTC.h"
+#include "InternalRTC.h"
 #include "Eeprom.h"
+#include "Wear.h"
+#include "Storage.h"
 #include "TemperatureSensor.h"
+#include "DataLog.h"
+#include "Acquisition.h"
+#include "Retention.h"
+#include "Crc32.h"
+#include "Filter.h"
+#include "AdcStream.h"
 /* USER CODE END Includes */
 
 /* Exported types ------------------------------------------------------------*/
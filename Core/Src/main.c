@@ -21,6 +21,11 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Alarm.h"
+#include "Burst.h"
+#include "NorFlash.h"
+#include "InternalFlash.h"
+#include "EepromArray.h"
 
 /* USER CODE END Includes */
 
@@ -31,6 +36,7 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+#define NOR_QUEUE_RECORDS		64			// Records waiting for the end of an erase of the flash
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -48,6 +54,9 @@ SPI_HandleTypeDef hspi2;
 UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
+FLOG_Log_t NOR_Log;
+uint8_t NOR_Queue[NOR_QUEUE_RECORDS * LOG_RECORD_SIZE];
+FLT_Filter_t TEMP_Filter;
 
 /* USER CODE END PV */
 
@@ -76,13 +85,19 @@ int main(void)
   /* USER CODE BEGIN 1 */
 
 	//Définition des variables
-	uint8_t lastSecondsCheck = 0;
-	uint32_t addr = 0;
-	uint8_t tmp[7];
-	uint32_t temperature;
+	uint32_t timestamp;
+	int16_t temperature;
+	uint16_t adcValues[AS_NB_CHANNELS];
 	RTC_Date_t RTC_Date;
 	RTC_Date_t RTC_Date_init = {22, 12, 24, 1, 9, 02, 56, 0, 0};
 	SQW_t squareWave = SQW_OFF_0;
+	LOG_Config_t LOG_Config = {LOG_MODE_DEADBAND, LOG_DEFAULT_DEADBAND, LOG_DEFAULT_HEARTBEAT};
+	//Un point par minute, cadence plus rapide quand la température varie de plus de 2 °C/min sur une minute (200 en 1/100 °C), plus lente sous 1 °C/min
+	ACQ_Config_t ACQ_Config = {{{60, ACQ_BUDGET_UNLIMITED}, {10, 180}, {1, 600}}, 200, 100, 5};
+	//Alarme hors de -10 °C / 60 °C ou sur une variation de plus de 5 °C entre deux scans (10 points par °C)
+	ALM_Threshold_t ALM_Temperature = {1100, 400, 50};
+	//Médiane glissante sur 5 points de la température : un point aberrant isolé ne déclenche pas d'alarme
+	FLT_Config_t TEMP_FilterConfig = {FLT_MEDIAN, 5, NULL};
 	/* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -121,64 +136,111 @@ int main(void)
   /* Infinite loop */
   /* USER CODE BEGIN WHILE */
 
+  IIC_Init();
+  IIC_Probe(RTC_addr, RTC_SPEED);
+  //RTC_Date_init n'est écrite que si la DS1307 a perdu l'heure (oscillateur arrêté ou date invalide)
   RTC_Init(RTC_Date_init, squareWave);
+  IRTC_Init();
+  IRTC_setWakeUp(IRTC_WAKEUP_PERIOD);
+  CRC32_Init();
+  TS_Init();
+  AS_Init();
+  AS_setExcitation(AS_SETTLE_DEFAULT);
+  WEAR_Init(LOG_WEAR_START, LOG_WEAR_SIZE);
+  EE_Tune(LOG_SCRATCH_START);
+#ifdef __DEBUG__
+  printf("EEPROM : SPI2 %lu Hz, %lu B/s\r\n", EE_getClock(), EE_getThroughput());
+  printf("EEPROM : %lu days of lifetime left\r\n", WEAR_getLifetime(IRTC_getTimestamp()));
+#endif
+  //EEPROM supplémentaires sur SPI2 : le journal des échantillons est réparti page par page sur toutes
+  //Le nombre d'EEPROM est mémorisé au premier démarrage : si une puce manque ou s'ajoute, le journal n'est plus écrit
+  EEA_Init(LOG_STRIPE_START);
+#ifdef __DEBUG__
+  printf("EEPROM : %u chip(s)%s\r\n", EEA_getChips(), (EEA_getDevice() == NULL) ? ", stripe changed : log stopped" : "");
+#endif
+  LOG_Init(LOG_Config, EEA_getDevice());
+  //Flash NOR optionnelle sur SPI2 : copie du journal des échantillons sur toute sa capacité
+  if(NOR_Init() == HAL_OK
+	  && FLOG_Init(&NOR_Log, NOR_getDevice(), 0, NOR_getDevice()->size, LOG_RECORD_SIZE, NOR_Queue, NOR_QUEUE_RECORDS) == HAL_OK)
+  {
+	  LOG_setMirror(&NOR_Log);
+  }
+  //Seconde moitié de la flash interne : les pages les plus anciennes du journal y sont déplacées avant d'être écrasées
+  if(IFL_Init() == HAL_OK)
+  {
+	  LOG_setOverflow(IFL_getLog());
+  }
+  ACQ_Init(ACQ_Config);
+  RET_Init(&STO_Eeprom);
+  ALM_Init();
+  ALM_setThreshold(LOG_CHANNEL_TEMPERATURE, ALM_Temperature);
+  if(FLT_Init(&TEMP_Filter, TEMP_FilterConfig) == HAL_OK)
+  {
+	  AS_setFilter(LOG_CHANNEL_TEMPERATURE, &TEMP_Filter);
+  }
+  AS_Start(ALM_RATE_DEFAULT, LOG_CHANNEL_ALL, ALM_Stream);
+  BST_Init();
 
   while (1)
   {
-	  RTC_getDate(&RTC_Date);
-
-	  if(RTC_Date.seconds == 0 &&  lastSecondsCheck == 59)
+	  //Date lue sur la RTC interne, recalée régulièrement sur la DS1307
+	  timestamp = IRTC_getTimestamp();
+	  if(IRTC_isSyncDue(timestamp))
 	  {
-		  lastSecondsCheck = RTC_Date.seconds;
-
-		  //Ajout d'une valeur en EEPROM
-		  temperature = TS_getTemperature();
-
-		  tmp[0] = RTC_Date.seconds;
-		  tmp[1] = RTC_Date.minutes;
-		  tmp[2] = RTC_Date.hour;
-		  if(RTC_Date.hourMode != AM_PM_NONE)
-		  {
-			  tmp[3] = RTC_Date.timeMode;
-			  tmp[4] = RTC_Date.dateNumber;
-			  tmp[5] = RTC_Date.month;
-			  tmp[6] = RTC_Date.year;
-			  tmp[7] = temperature;
-
-			  EE_Write(addr, tmp, 8);
-
-			  addr += 8;
-			  if(addr >= 0x7FFFF) addr = 0;
-
-		  }
-		  else
-		  {
-			  tmp[3] = RTC_Date.dateNumber;
-			  tmp[4] = RTC_Date.month;
-			  tmp[5] = RTC_Date.year;
-
-			  tmp[6] = temperature;
-
-			  EE_Write(addr, tmp, 7);
+		  IRTC_Sync();
+		  timestamp = IRTC_getTimestamp();
+	  }
 
-			  addr += 7;
-			  if(addr >= 0x7FFFF) addr = 0;
+	  if(ACQ_isSampleDue(timestamp) && ALM_getScan(adcValues) == HAL_OK)
+	  {
+		  //Capteur externe et santé de la carte (température MCU, VREFINT, VBAT) : dernier scan du flux surveillé par les alarmes
+		  temperature = TS_toTemperature(adcValues[0], adcValues[2]);
 
-		  }
+		  //Ajout d'une valeur en EEPROM (uniquement si elle sort de la bande morte)
+		  ACQ_Update(timestamp, temperature);
+		  LOG_Process(timestamp, LOG_CHANNEL_TEMPERATURE, temperature);
+		  LOG_Process(timestamp, LOG_CHANNEL_MCU_TEMP, TS_toMcuTemperature(adcValues[1], adcValues[2]));
+		  LOG_Process(timestamp, LOG_CHANNEL_VREFINT, TS_toVdda(adcValues[2]));
+		  LOG_Process(timestamp, LOG_CHANNEL_VBAT, TS_toVbat(adcValues[3], adcValues[2]));
+		  RET_Add(timestamp, temperature);
 
 #ifdef __DEBUG__
-		  printf("Temperature written : %ld\r\n", temperature);
+		  printf("Temperature sampled : %d (1/100 C)\r\n", temperature);
 #endif
 
 	  }
 
-
-	  lastSecondsCheck = RTC_Date.seconds;
 #ifdef __DEBUG__
 	  //	dd/mm/aaaa - day - hh:mm:ss
+	  RTC_fromTimestamp(timestamp, &RTC_Date);
 	  printf("%02d/%02d/20%02d - %d - %02d:%02d:%02d\r\n", RTC_Date.dateNumber, RTC_Date.month, RTC_Date.year, RTC_Date.day, RTC_Date.hour, RTC_Date.minutes, RTC_Date.seconds);
 #endif
-	  HAL_Delay(10);
+	  //Enregistrement d'un évènement capturé par les alarmes
+	  ALM_Process();
+
+	  //Surveillance du bus I2C (transfert bloqué, récupération du bus)
+	  IIC_Process();
+
+	  //Sauvegarde des compteurs d'usure de l'EEPROM
+	  WEAR_Process();
+
+	  //Écriture des enregistrements en attente et effacement des secteurs devant la tête de la flash
+	  FLOG_Process(&NOR_Log);
+	  FLOG_Process(IFL_getLog());
+
+	  //Rafale demandée par B1 : capteur alimenté en continu le temps de la rafale, puis retour au flux des alarmes
+	  if(BST_isRequested())
+	  {
+		  AS_Stop();
+		  AS_setExcitation(AS_EXCITATION_ALWAYS);
+		  BST_Run();
+		  AS_setExcitation(AS_SETTLE_DEFAULT);
+		  AS_Start(ALM_RATE_DEFAULT, LOG_CHANNEL_ALL, ALM_Stream);
+	  }
+
+	  //Fin des transferts DMA de l'EEPROM (CS relâché : la dernière page est programmée), puis mise en veille jusqu'au prochain réveil de la RTC interne
+	  EE_EndTransfer();
+	  IRTC_Sleep();
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
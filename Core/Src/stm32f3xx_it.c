@@ -22,6 +22,7 @@
 #include "stm32f3xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Burst.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -199,6 +200,60 @@ void SysTick_Handler(void)
 /******************************************************************************/
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles RTC wake-up interrupt through EXTI line 20.
+  */
+void RTC_WKUP_IRQHandler(void)
+{
+  IRTC_IRQHandler();
+}
+
+/**
+  * @brief This function handles DMA1 channel1 global interrupt (ADC1).
+  */
+void DMA1_Channel1_IRQHandler(void)
+{
+  AS_IRQHandler();
+}
 
+/**
+  * @brief This function handles EXTI line[15:10] interrupts (B1).
+  */
+void EXTI15_10_IRQHandler(void)
+{
+  BST_IRQHandler();
+}
+
+/**
+  * @brief This function handles I2C1 event global interrupt / I2C1 wake-up interrupt through EXTI line 23.
+  */
+void I2C1_EV_IRQHandler(void)
+{
+  IIC_EventIRQHandler();
+}
+
+/**
+  * @brief This function handles I2C1 error interrupt.
+  */
+void I2C1_ER_IRQHandler(void)
+{
+  IIC_ErrorIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA1 channel6 global interrupt (I2C1_TX).
+  */
+void DMA1_Channel6_IRQHandler(void)
+{
+  IIC_TxIRQHandler();
+}
+
+/**
+  * @brief This function handles DMA1 channel7 global interrupt (I2C1_RX).
+  */
+void DMA1_Channel7_IRQHandler(void)
+{
+  IIC_RxIRQHandler();
+}
 /* USER CODE END 1 */
 
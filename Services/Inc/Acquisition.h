@@ -0,0 +1,70 @@
+/*
+ * Acquisition.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_ACQUISITION_H_
+#define INC_ACQUISITION_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define ACQ_NB_RATES			3			// Number of sampling rates, from the slowest (0) to the fastest
+#define ACQ_BUDGET_WINDOW		3600		// Window of the sample budgets (s)
+#define ACQ_BUDGET_UNLIMITED	0
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * ACQ_Rate_t definition
+ * period	: Time between two samples (s)
+ * budget	: Maximum number of samples at this rate in a budget window (ACQ_BUDGET_UNLIMITED for none)
+ */
+typedef struct
+{
+	uint32_t period;
+	uint16_t budget;
+} ACQ_Rate_t;
+
+/*
+ * ACQ_Config_t definition
+ * rate			: Sampling rates, from the slowest to the fastest
+ * slopeUp		: Slope (sensor unit per minute, over the period of rate[0]) above which the next faster rate is used
+ * slopeDown	: Slope (sensor unit per minute) below which the signal is stable, lower than slopeUp (hysteresis)
+ * holdCount	: Number of consecutive stable samples before the next slower rate is used
+ */
+typedef struct
+{
+	ACQ_Rate_t rate[ACQ_NB_RATES];
+	uint16_t slopeUp;
+	uint16_t slopeDown;
+	uint8_t holdCount;
+} ACQ_Config_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+void ACQ_Init(ACQ_Config_t config);
+
+uint8_t ACQ_isSampleDue(uint32_t timestamp);
+void ACQ_Update(uint32_t timestamp, int16_t value);
+
+uint8_t ACQ_getRate(void);
+uint32_t ACQ_getPeriod(void);
+
+#endif /* INC_ACQUISITION_H_ */
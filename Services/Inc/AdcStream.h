@@ -0,0 +1,88 @@
+/*
+ * AdcStream.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_ADCSTREAM_H_
+#define INC_ADCSTREAM_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "DataLog.h"
+#include "Filter.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define AS_RATE_MIN				1			// Lowest sample rate (Hz)
+#define AS_RATE_MAX				50000		// Highest sample rate (Hz)
+
+#define AS_BUFFER_SIZE			512			// Samples of the DMA buffer, delivered by halves
+#define AS_NB_CHANNELS			LOG_NB_CHANNELS	// Channels of the scan, in the order of the bits of LOG_CHANNEL_xxx
+
+#define AS_TIMEOUT				10			// Timeout of a single scan (ms)
+
+#define AS_TIMEBASE				1000000UL	// Frequency of the timestamps (Hz)
+
+#define AS_EXCITATION_ALWAYS	0			// ADC1_VCC kept on between the conversions
+#define AS_SETTLE_DEFAULT		1000		// Settling time of the sensor after its excitation is switched on (us)
+#define AS_SETTLE_MAX			100000		// Longest settling time (us)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * AS_Block_t definition
+ * Block of scans converted by the DMA
+ * timestamp	: Time of the trigger of the first scan (us, TIM2 counter, wraps after 71 min)
+ * index		: Number of the first scan since AS_Start
+ * period		: Interval between two scans (us)
+ * count		: Number of scans
+ * channels		: Bitmap of the channels of each scan (LOG_CHANNEL_xxx)
+ * width		: Number of channels of each scan
+ * samples		: Conversions of the ADC after the filters, interleaved : samples[scan * width + channel]
+ */
+typedef struct
+{
+	uint32_t timestamp;
+	uint32_t index;
+	uint32_t period;
+	uint16_t count;
+	uint8_t channels;
+	uint8_t width;
+	uint16_t * samples;
+} AS_Block_t;
+
+typedef void (*AS_Callback_t)(AS_Block_t * block);
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef AS_Init(void);
+
+HAL_StatusTypeDef AS_Start(uint32_t rate, uint8_t channels, AS_Callback_t callback);
+HAL_StatusTypeDef AS_Stop(void);
+
+HAL_StatusTypeDef AS_Read(uint8_t channels, uint16_t * values);
+
+HAL_StatusTypeDef AS_setExcitation(uint32_t settle);
+
+void AS_setFilter(uint8_t channel, FLT_Filter_t * filter);
+
+uint32_t AS_getPeriod(void);
+uint32_t AS_getTime(void);
+
+void AS_IRQHandler(void);
+
+#endif /* INC_ADCSTREAM_H_ */
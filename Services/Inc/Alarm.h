@@ -0,0 +1,120 @@
+/*
+ * Alarm.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_ALARM_H_
+#define INC_ALARM_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <stddef.h>
+#include "main.h"
+#include "AdcStream.h"
+#include "DataLog.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define ALM_RATE_DEFAULT		100			// Rate of the stream watched by the alarms (Hz)
+
+#define ALM_PRE_SCANS			256			// Scans kept before the trigger
+#define ALM_POST_SCANS			256			// Scans captured from the trigger
+#define ALM_SCANS				(ALM_PRE_SCANS + ALM_POST_SCANS)
+
+#define ALM_HIGH_OFF			0xFFFF		// Thresholds of a channel without alarm
+#define ALM_LOW_OFF				0
+#define ALM_RATE_OFF			0
+#define ALM_HYSTERESIS			16			// Margin inside the thresholds to arm the alarms again (raw counts)
+
+/*
+ * EVENT REGION
+ * One slot per event, the oldest one is overwritten : header followed by the scans (pre + post),
+ * interleaved as in AS_Block_t.
+ */
+#define ALM_EVENT_SIZE			sizeof(ALM_Event_t)
+#define ALM_SLOT_SIZE			(((ALM_EVENT_SIZE + ALM_SCANS * AS_NB_CHANNELS * sizeof(uint16_t)) / EE_SIZE_PAGE + 1) * EE_SIZE_PAGE)
+#define ALM_NB_SLOTS			(LOG_EVENT_SIZE / ALM_SLOT_SIZE)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	ALM_NONE	= 0,
+	ALM_HIGH	= 1,	// The sample went above the high threshold
+	ALM_LOW		= 2,	// The sample went below the low threshold
+	ALM_RATE	= 3		// The sample changed by more than the rate since the previous scan
+}ALM_Type_t;
+
+/*
+ * ALM_Threshold_t definition
+ * Alarm thresholds of a channel, in raw counts of the ADC after the filter of the channel
+ * high	: Highest value allowed (ALM_HIGH_OFF to disable)
+ * low	: Lowest value allowed (ALM_LOW_OFF to disable)
+ * rate	: Largest change between two scans (ALM_RATE_OFF to disable)
+ */
+typedef struct
+{
+	uint16_t high;
+	uint16_t low;
+	uint16_t rate;
+} ALM_Threshold_t;
+
+/*
+ * ALM_Event_t definition
+ * Header of an event in the EEPROM, 32 Bytes
+ * sequence		: Number of the event since the first one, 0xFFFFFFFF for an empty slot
+ * timestamp	: Time of the trigger in seconds since 01/01/2000 00:00:00
+ * time			: Time of the trigger scan (us, see AS_Block_t)
+ * period		: Interval between two scans (us)
+ * pre			: Number of scans before the trigger
+ * post			: Number of scans from the trigger
+ * channels		: Bitmap of the channels of each scan (LOG_CHANNEL_xxx)
+ * width		: Number of channels of each scan
+ * channel		: Channel that fired the alarm (one LOG_CHANNEL_xxx)
+ * type			: Threshold crossed (ALM_Type_t)
+ * value		: Sample that fired the alarm (raw counts)
+ * crc			: CRC-32 of the header before this field and of the scans
+ */
+typedef struct
+{
+	uint32_t sequence;
+	uint32_t timestamp;
+	uint32_t time;
+	uint32_t period;
+	uint16_t pre;
+	uint16_t post;
+	uint8_t channels;
+	uint8_t width;
+	uint8_t channel;
+	uint8_t type;
+	uint16_t value;
+	uint16_t reserved;
+	uint32_t crc;
+} ALM_Event_t;
+
+typedef void (*ALM_Callback_t)(ALM_Event_t * event, uint32_t addr);
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef ALM_Init(void);
+void ALM_setThreshold(uint8_t channel, ALM_Threshold_t threshold);
+
+void ALM_Stream(AS_Block_t * block);
+HAL_StatusTypeDef ALM_Process(void);
+
+HAL_StatusTypeDef ALM_getScan(uint16_t * values);
+HAL_StatusTypeDef ALM_Export(ALM_Callback_t callback);
+
+#endif /* INC_ALARM_H_ */
@@ -0,0 +1,92 @@
+/*
+ * Burst.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_BURST_H_
+#define INC_BURST_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <stddef.h>
+#include "main.h"
+#include "AdcStream.h"
+#include "DataLog.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define BST_RATE				10000		// Scan rate of a burst (Hz), highest rate the EEPROM writes can follow
+#define BST_DURATION			1000		// Length of a burst (ms)
+#define BST_CHANNELS			LOG_CHANNEL_TEMPERATURE	// Channels of a burst
+
+#define BST_FIFO_PAGES			8			// Pages buffered between the DMA and the EEPROM
+#define BST_DEBOUNCE			300			// Presses of B1 closer than this are ignored (ms)
+#define BST_TIMEOUT				500			// Margin on the length of a burst before it is aborted (ms)
+
+#define BST_FLAG_OVERRUN		0x01		// The EEPROM did not follow, the burst was cut short
+
+/*
+ * BURST REGION
+ * Page 0 : Header of the last burst
+ * Next pages : Scans of the burst, interleaved as in AS_Block_t. They start at the least worn
+ * place of the region which can hold them (see WEAR_Allocate), given by the header.
+ */
+#define BST_HEADER_SIZE			sizeof(BST_Header_t)
+#define BST_DATA_START			(LOG_BURST_START + EE_SIZE_PAGE)
+#define BST_DATA_SIZE			(LOG_BURST_SIZE - EE_SIZE_PAGE)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * BST_Header_t definition
+ * Header of the burst stored in the EEPROM, 28 Bytes
+ * timestamp	: Start of the burst in seconds since 01/01/2000 00:00:00
+ * time			: Time of the first scan (us, see AS_Block_t)
+ * period		: Interval between two scans (us)
+ * count		: Number of scans stored
+ * start		: Address of the first scan in the EEPROM
+ * channels		: Bitmap of the channels of each scan (LOG_CHANNEL_xxx)
+ * width		: Number of channels of each scan
+ * flags		: BST_FLAG_xxx
+ * reserved		: 0xFF
+ * crc			: CRC-32 of the header before this field and of the scans
+ */
+typedef struct
+{
+	uint32_t timestamp;
+	uint32_t time;
+	uint32_t period;
+	uint32_t count;
+	uint32_t start;
+	uint8_t channels;
+	uint8_t width;
+	uint8_t flags;
+	uint8_t reserved;
+	uint32_t crc;
+} BST_Header_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+void BST_Init(void);
+
+uint8_t BST_isRequested(void);
+HAL_StatusTypeDef BST_Run(void);
+
+HAL_StatusTypeDef BST_getHeader(BST_Header_t * header);
+
+void BST_IRQHandler(void);
+
+#endif /* INC_BURST_H_ */
@@ -0,0 +1,40 @@
+/*
+ * Crc32.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_CRC32_H_
+#define INC_CRC32_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <string.h>
+#include "main.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define CRC32_POLYNOMIAL		0x04C11DB7	// CRC-32 (Ethernet) polynomial
+#define CRC32_INIT				0xFFFFFFFF	// Value of the CRC before the first Byte
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+void CRC32_Init(void);
+
+uint32_t CRC32_Compute(uint8_t * data, uint16_t length);
+uint32_t CRC32_Accumulate(uint32_t crc, uint8_t * data, uint16_t length);
+
+#endif /* INC_CRC32_H_ */
@@ -0,0 +1,218 @@
+/*
+ * DataLog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_DATALOG_H_
+#define INC_DATALOG_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "Eeprom.h"
+#include "Storage.h"
+#include "FlashLog.h"
+#include "RTC.h"
+#include "Crc32.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+/*
+ * EEPROM MAP (2048 pages of 256 Bytes)
+ * 0x00000 - 0x4EFFF : Sample log (raw records)	pages    0 - 1263
+ * 0x4F000 - 0x4FEFF : Wear counters (see Wear.h)	pages 1264 - 1278
+ * 0x4FF00 - 0x4FFFF : Geometry of the stripe (see EepromArray.h)	page  1279
+ * 0x50000 - 0x57EFF : Burst capture (see Burst.h)	pages 1280 - 1406
+ * 0x57F00 - 0x57FFF : Scratch page of EE_Tune		page  1407
+ * 0x58000 - 0x5FFFF : Alarm events (see Alarm.h)	pages 1408 - 1535
+ * 0x60000 - 0x77FFF : Hourly rollups				pages 1536 - 1919
+ * 0x78000 - 0x7FFFF : Daily rollups				pages 1920 - 2047
+ */
+#define LOG_RAW_START			0x00000		// First address of the sample log in the EEPROM
+#define LOG_RAW_SIZE			0x4F000		// Size of the sample log (316 KB)
+#define LOG_WEAR_START			0x4F000		// First address of the copies of the wear counters
+#define LOG_WEAR_SIZE			0x00F00		// Size of the copies of the wear counters (5 slots of 3 pages)
+#define LOG_STRIPE_START		0x4FF00		// Page of the number of chips of the stripe (see EEA_Init)
+#define LOG_BURST_START			0x50000		// First address of the burst capture
+#define LOG_BURST_SIZE			0x07F00		// Size of the burst capture (32 KB - 1 page)
+#define LOG_SCRATCH_START		0x57F00		// Page of the SPI link self-test and of the clock it kept (see EE_Tune)
+#define LOG_EVENT_START			0x58000		// First address of the alarm events
+#define LOG_EVENT_SIZE			0x08000		// Size of the alarm events (32 KB)
+#define LOG_HOURLY_START		0x60000		// First address of the hourly rollups
+#define LOG_HOURLY_SIZE			0x18000		// Size of the hourly rollups (96 KB, 256 days)
+#define LOG_DAILY_START			0x78000		// First address of the daily rollups
+#define LOG_DAILY_SIZE			0x08000		// Size of the daily rollups (32 KB, 5.6 years)
+
+#define LOG_RECORD_SIZE			sizeof(LOG_Record_t)
+
+//Chips of a stripe of EEPROMs the sample log spreads over, its index takes 5 KB of RAM per chip
+#ifndef LOG_RAW_CHIPS
+#define LOG_RAW_CHIPS			1			// Build flag -DLOG_RAW_CHIPS=n, 1 to EEA_MAX_CHIPS
+#endif
+
+/*
+ * PAGE LAYOUT
+ * The records fill the beginning of each page, the unused Bytes are left at 0xFF.
+ * The 4 Bytes before the CRC hold the sequence number of the page, written with its first record :
+ * the newest page is the one with the highest number, whatever the clock did (see IDX_Build).
+ * The last 4 Bytes of the page hold the CRC-32 of the 252 first ones, written once the page is full
+ * or when the clock goes back (see LOG_RingAlign).
+ * Until then the CRC reads LOG_UNSEALED and each append programs only its record :
+ * an append interrupted by a reset cannot spoil the records already on the page.
+ */
+#define LOG_PAGE_DATA			(EE_SIZE_PAGE - sizeof(uint32_t))	// Bytes covered by the CRC of a page
+#define LOG_PAGE_SEQUENCE		(LOG_PAGE_DATA - sizeof(uint32_t))	// Offset of the sequence number, end of the records
+#define LOG_UNSEALED			0xFFFFFFFF	// CRC of a page which is not sealed yet
+#define LOG_RECORDS_PER_PAGE(length)	(LOG_PAGE_SEQUENCE / (length))
+
+#define LOG_CHANNEL_TEMPERATURE	0x01		// External temperature sensor (ADC1_IN1), 1/100 °C
+#define LOG_CHANNEL_MCU_TEMP	0x02		// Internal temperature sensor of the MCU (ADC1_IN16), 1/100 °C
+#define LOG_CHANNEL_VREFINT		0x04		// Internal voltage reference (ADC1_IN18), logged as VDDA in mV
+#define LOG_CHANNEL_VBAT		0x08		// Backup battery, VBAT/2 (ADC1_IN17), logged in mV
+#define LOG_CHANNEL_ALL			0x0F
+#define LOG_NB_CHANNELS			4
+
+#define LOG_FLAG_FIRST			0x01		// First record stored after a reset
+#define LOG_FLAG_CHANGE			0x02		// The value left the dead-band around the last stored value
+#define LOG_FLAG_HEARTBEAT		0x04		// The heartbeat interval elapsed without any change
+#define LOG_FLAG_EVENT			0x08		// An alarm fired, the value is the number of the event (see Alarm.h)
+
+#define LOG_DEFAULT_DEADBAND	25			// Default dead-band half width (unit of the channel : 0.25 °C, 25 mV)
+#define LOG_DEFAULT_HEARTBEAT	3600		// Default maximum time between two records (s)
+
+#define LOG_SCAN_PAGES			4			// Pages of the chunk buffer of LOG_RingScan (two chunks)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	LOG_MODE_PERIODIC	= 0,	// Every sample is stored
+	LOG_MODE_DEADBAND	= 1		// A sample is stored only if it leaves the dead-band or if the heartbeat elapsed
+}LOG_Mode_t;
+
+/*
+ * LOG_Record_t definition
+ * One record of the sample log, 8 Bytes (31 records per EEPROM page)
+ * timestamp	: Seconds since 01/01/2000 00:00:00 (see RTC_toTimestamp)
+ * value		: Value of the sample
+ * channel		: Bitmap of the channel(s) of the value (LOG_CHANNEL_xxx)
+ * flags		: Reason of the storage (LOG_FLAG_xxx)
+ */
+typedef struct
+{
+	uint32_t timestamp;
+	int16_t value;
+	uint8_t channel;
+	uint8_t flags;
+} LOG_Record_t;
+
+/*
+ * LOG_Config_t definition
+ * mode			: Logging mode
+ * deadBand		: Half width of the dead-band around the last stored value
+ * heartbeat	: Maximum time between two records in seconds, whatever the value
+ */
+typedef struct
+{
+	LOG_Mode_t mode;
+	uint16_t deadBand;
+	uint32_t heartbeat;
+} LOG_Config_t;
+
+/*
+ * LOG_Ring_t definition
+ * Circular area of a storage device. The oldest records are overwritten when the area is full.
+ * The records must start with their timestamp.
+ * start	: First address of the area (page aligned)
+ * size		: Size of the area in Bytes (multiple of the page size)
+ * head		: Address where the next record will be written
+ * wrapped	: The area has been filled at least once
+ * index	: Timestamp of the first record of each page (see LogIndex.h)
+ * page		: Copy in RAM of the page of the head (EE_SIZE_PAGE Bytes)
+ * device	: Storage device of the area, written in place (see LOG_RingInit)
+ * sequence	: Sequence number of the newest page (see PAGE LAYOUT)
+ * last		: Timestamp of the newest record
+ */
+typedef struct
+{
+	uint32_t start;
+	uint32_t size;
+	uint32_t head;
+	uint8_t wrapped;
+	uint32_t * index;
+	uint8_t * page;
+	const STO_Device_t * device;
+	uint32_t sequence;
+	uint32_t last;
+} LOG_Ring_t;
+
+typedef void (*LOG_Callback_t)(LOG_Record_t * record);
+typedef void (*LOG_Visitor_t)(uint8_t * record);
+
+/*
+ * LOG_Scan_t definition
+ * State of LOG_RingScan between two chunks of pages
+ * ring		: Circular area
+ * length	: Size of one record
+ * addr		: Address of the next record
+ * page		: Address of the next page of the stream
+ * count	: Records left up to the head
+ * t0		: Records older than t0 are skipped
+ * t1		: Records newer than t1 stop the scan, or are skipped if the clock went back
+ * visitor	: Function called for each record of the time range
+ * ordered	: The records follow the time (see IDX_isOrdered)
+ * done		: A record newer than t1 was found
+ */
+typedef struct
+{
+	LOG_Ring_t * ring;
+	uint16_t length;
+	uint32_t addr;
+	uint32_t page;
+	uint32_t count;
+	uint32_t t0;
+	uint32_t t1;
+	LOG_Visitor_t visitor;
+	uint8_t ordered;
+	uint8_t done;
+} LOG_Scan_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef LOG_Init(LOG_Config_t config, const STO_Device_t * device);
+void LOG_SetConfig(LOG_Config_t config);
+
+HAL_StatusTypeDef LOG_Process(uint32_t timestamp, uint8_t channel, int16_t value);
+HAL_StatusTypeDef LOG_Append(LOG_Record_t * record);
+HAL_StatusTypeDef LOG_Event(uint32_t timestamp, uint8_t channel, uint16_t number);
+
+HAL_StatusTypeDef LOG_Export(LOG_Callback_t callback);
+HAL_StatusTypeDef LOG_Query(uint32_t t0, uint32_t t1, LOG_Callback_t callback);
+
+uint32_t LOG_getCrcErrors(void);
+uint32_t LOG_getTierErrors(void);
+void LOG_setMirror(FLOG_Log_t * log);
+void LOG_setOverflow(FLOG_Log_t * log);
+
+HAL_StatusTypeDef LOG_RingInit(LOG_Ring_t * ring, uint16_t length);
+HAL_StatusTypeDef LOG_RingAlign(LOG_Ring_t * ring, uint8_t * data);
+HAL_StatusTypeDef LOG_RingWrite(LOG_Ring_t * ring, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef LOG_RingScan(LOG_Ring_t * ring, uint16_t length, uint32_t addr, uint32_t t0, uint32_t t1, LOG_Visitor_t visitor);
+uint32_t LOG_RingCount(LOG_Ring_t * ring, uint16_t length);
+uint32_t LOG_RingDistance(LOG_Ring_t * ring, uint32_t addr, uint16_t length);
+uint32_t LOG_RingOldest(LOG_Ring_t * ring);
+uint32_t LOG_RingNext(LOG_Ring_t * ring, uint32_t addr, uint16_t length);
+
+#endif /* INC_DATALOG_H_ */
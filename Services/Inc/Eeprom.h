@@ -22,6 +22,17 @@
 
 #define EE_SIZE_PAGE			0x100		// Size of one page of the EEPROM memory (256 octets)
 #define EE_LAST_PAGE			0x7FF		// Address of the last page available of the EEPROM memory (2048)
+#define EE_SIZE_MEMORY			((EE_LAST_PAGE + 1) * EE_SIZE_PAGE)	// 512 KB
+#define EE_TIMEOUT				10			// Longest DMA transfer of a page (ms)
+#define EE_CACHE_LINES			4			// Pages kept by the read cache of EE_Read
+
+#define EE_PRESCALER_SAFE		SPI_BAUDRATEPRESCALER_8		// Prescaler of MX_SPI2_Init, used to write the test pattern
+#define EE_TUNE_PASSES			3			// Read-backs a prescaler must pass to be kept
+#define EE_TUNE_TIME			20			// Length of the throughput measure (ms)
+
+//Hardware NSS of SPI2, held high while another chip of the bus is selected (see EE_Select)
+#define EE_NSS_PORT				GPIOB
+#define EE_NSS_PIN				GPIO_PIN_12
 
 
 /*
@@ -54,6 +65,34 @@ typedef enum
 	SRST	= 0x7C		// Software Device Reset
 }EE_opcode_t;
 
+/*
+ * EE_Vector_t definition
+ * Buffer of a vectored access (EE_Writev, EE_Readv)
+ * data		: First Byte of the buffer
+ * length	: Number of Bytes
+ */
+typedef struct
+{
+	uint8_t * data;
+	uint16_t length;
+} EE_Vector_t;
+
+typedef uint8_t (*EE_Callback_t)(uint8_t * data, uint16_t length);
+
+/*
+ * EE_CacheStats_t definition
+ * Counters of the read cache of EE_Read
+ * hits			: Pages of the reads found in the cache (prefetched ones included)
+ * misses		: Pages of the reads read from the EEPROM
+ * prefetches	: Pages read ahead by DMA
+ */
+typedef struct
+{
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t prefetches;
+} EE_CacheStats_t;
+
 /*
  * PUBLIC GLOBAL VARIABLE
  */
@@ -67,7 +106,21 @@ HAL_StatusTypeDef EE_WriteStatusRegister(uint16_t status);
 HAL_StatusTypeDef EE_ReadStatusRegister(uint16_t * status);
 HAL_StatusTypeDef EE_Write(uint32_t addr, uint8_t * data, uint16_t length);
 HAL_StatusTypeDef EE_Read(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef EE_Writev(uint32_t addr, const EE_Vector_t * vector, uint8_t count);
+HAL_StatusTypeDef EE_Readv(uint32_t addr, const EE_Vector_t * vector, uint8_t count);
+HAL_StatusTypeDef EE_Stream(uint32_t addr, uint32_t length, uint8_t * buffer, uint16_t size, EE_Callback_t callback);
+void EE_getCacheStats(EE_CacheStats_t * stats);
+HAL_StatusTypeDef EE_Sync(void);
+HAL_StatusTypeDef EE_EndTransfer(void);
+uint8_t EE_isBusy(void);
+
+void EE_Select(GPIO_TypeDef * port, uint16_t pin);
+void EE_Deselect(GPIO_TypeDef * port, uint16_t pin);
 
 void EE_getID(uint8_t *);
 
+HAL_StatusTypeDef EE_Tune(uint32_t scratch);
+uint32_t EE_getClock(void);
+uint32_t EE_getThroughput(void);
+
 #endif /* INC_EEPROM_H_ */
@@ -0,0 +1,66 @@
+/*
+ * EepromArray.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_EEPROMARRAY_H_
+#define INC_EEPROMARRAY_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "Storage.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define EEA_MAX_CHIPS			4			// EEPROMs of the stripe, the one of the hardware NSS included
+#define EEA_TIMEOUT_WRITE		10			// Longest write cycle of a page (ms)
+#define EEA_MAGIC				0x41454545	// "EEEA", first word of the geometry of the stripe
+
+//Chip selects of the EEPROMs added on SPI2, the first EEPROM keeps the hardware NSS on PB12 (see EE_Select)
+#define EEA_CS_PORT				GPIOC
+#define EEA_CS_PIN_1			GPIO_PIN_9
+#define EEA_CS_PIN_2			GPIO_PIN_10
+#define EEA_CS_PIN_3			GPIO_PIN_11
+
+/*
+ * STRIPE LAYOUT
+ * The pages of the device go to the chips in turn : page N is the page N / chips of the chip N % chips.
+ * A program of several pages starts the next page on the next chip while the previous chip is still
+ * in its write cycle, only a chip written again is waited for. The same range of each chip is used,
+ * the area [0, size) of the device lies in [0, size / chips) on every chip.
+ * The sample log writes one record at a time inside one page (see LOG_RingWrite) : its writes only
+ * overlap when a page is left for the next one, the stripe adds capacity, not append rate.
+ * The first EEPROM is accessed by the Eeprom driver (cache, wear counters), the other ones are
+ * accessed here through EE_Select. Changing the number of chips changes the order of the pages :
+ * the number of chips is stored on the first EEPROM at the first start (see EEA_Init), and the
+ * stripe is refused if another number is found later, a chip missing at boot included.
+ * To use a new stripe on purpose, the page of the geometry is written back to 0xFF.
+ */
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef EEA_Init(uint32_t geometry);
+uint8_t EEA_getChips(void);
+const STO_Device_t * EEA_getDevice(void);
+
+HAL_StatusTypeDef EEA_Read(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef EEA_Program(uint32_t addr, uint8_t * data, uint16_t length);
+uint8_t EEA_isBusy(void);
+
+#endif /* INC_EEPROMARRAY_H_ */
@@ -0,0 +1,83 @@
+/*
+ * Filter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_FILTER_H_
+#define INC_FILTER_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <string.h>
+#include "stm32f3xx_hal.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define FLT_FIR_MAX_TAPS		32			// Taps of a FIR filter (Q15 coefficients)
+#define FLT_IIR_MAX_SECTIONS	5			// Cascaded biquads of an IIR filter (Q14 coefficients)
+#define FLT_MEDIAN_MAX			9			// Window of a moving median (odd)
+#define FLT_BLOCK_MAX			256			// Samples filtered at once, longer blocks are cut
+
+#define FLT_IIR_COEFFICIENTS	5			// b0 b1 b2 a1 a2 for each section
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	FLT_NONE	= 0,
+	FLT_FIR		= 1,	// y[n] = sum(h[k] * x[n-k]), Q15
+	FLT_IIR		= 2,	// Biquads in direct form I, y[n] = b0.x[n] + b1.x[n-1] + b2.x[n-2] - a1.y[n-1] - a2.y[n-2], Q14
+	FLT_MEDIAN	= 3		// Median of the last samples
+}FLT_Type_t;
+
+/*
+ * FLT_Config_t definition
+ * type			: FLT_FIR, FLT_IIR or FLT_MEDIAN
+ * length		: Number of taps (FIR), of sections (IIR) or size of the window (median)
+ * coefficients	: h[0..length-1] (FIR), {b0, b1, b2, a1, a2} for each section (IIR), unused (median)
+ */
+typedef struct
+{
+	FLT_Type_t type;
+	uint8_t length;
+	const int16_t * coefficients;
+} FLT_Config_t;
+
+/*
+ * FLT_Filter_t definition
+ * Coefficients and state of a filter, the coefficients are stored by pairs for SMLAD
+ * FIR		: h in reverse order, padded to an even number of taps, and the last inputs
+ * IIR		: {b0, b1, b2, -a1, -a2, 0} and {x[n-1], x[n-2], y[n-1], y[n-2]} for each section
+ * Median	: Window in the order of arrival and sorted
+ */
+typedef struct
+{
+	FLT_Type_t type;
+	uint8_t length;
+	uint8_t primed;				// The state was filled with the first sample
+	uint8_t position;			// Oldest sample of the median window
+	int16_t coefficients[FLT_FIR_MAX_TAPS] __attribute__((aligned(4)));
+	int16_t history[FLT_FIR_MAX_TAPS] __attribute__((aligned(4)));
+	int16_t sorted[FLT_MEDIAN_MAX];
+} FLT_Filter_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef FLT_Init(FLT_Filter_t * filter, FLT_Config_t config);
+void FLT_Reset(FLT_Filter_t * filter);
+
+void FLT_Process(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride);
+
+#endif /* INC_FILTER_H_ */
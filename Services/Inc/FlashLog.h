@@ -0,0 +1,104 @@
+/*
+ * FlashLog.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_FLASHLOG_H_
+#define INC_FLASHLOG_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <string.h>
+#include "stm32f3xx_hal.h"
+#include "Storage.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define FLOG_MAGIC				0x474F4C46	// "FLOG", first word of a sector in use
+#define FLOG_ERASE_AHEAD		2			// Sectors kept erased in front of the head
+#define FLOG_RECORD_MAX			32			// Longest record
+#define FLOG_EMPTY				0xFFFFFFFF	// Timestamp of an erased record
+
+/*
+ * SECTOR LAYOUT
+ * Header (FLOG_Sector_t) followed by the records, a record never crosses a sector.
+ * Each record is programmed once into erased Bytes, the first empty record ends the sector.
+ */
+#define FLOG_HEADER_SIZE		sizeof(FLOG_Sector_t)
+#define FLOG_RECORDS_PER_SECTOR(log)	(((log)->device->sector - FLOG_HEADER_SIZE) / (log)->length)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * FLOG_Sector_t definition
+ * Header of a sector of the log, 8 Bytes
+ * magic	: FLOG_MAGIC
+ * sequence	: Number of the sector since the first one, gives the order of the sectors
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t sequence;
+} FLOG_Sector_t;
+
+/*
+ * FLOG_Log_t definition
+ * Log of records on a device erased by sectors (NOR flash). The records are queued in RAM by
+ * FLOG_Append and programmed by FLOG_Process when the device is free, which also erases the
+ * sectors in front of the head : neither of them waits for an erase.
+ * device	: Storage device, with sectors
+ * start	: First address of the log (sector aligned)
+ * size		: Size of the log (multiple of the sector, FLOG_ERASE_AHEAD + 2 sectors at least)
+ * length	: Size of one record, starting with its timestamp
+ * sector	: Sector of the head, FLOG_EMPTY before the first one
+ * head		: Address of the next record in this sector
+ * sequence	: Sequence of this sector
+ * ready	: Sectors erased in front of it
+ * queue	: Records waiting to be programmed (capacity * length Bytes)
+ * capacity	: Size of the queue in records
+ * first	: Oldest record of the queue
+ * count	: Records in the queue
+ * dropped	: Records lost because the queue was full
+ */
+typedef struct
+{
+	const STO_Device_t * device;
+	uint32_t start;
+	uint32_t size;
+	uint16_t length;
+	uint32_t sector;
+	uint32_t head;
+	uint32_t sequence;
+	uint8_t ready;
+	uint8_t * queue;
+	uint16_t capacity;
+	uint16_t first;
+	uint16_t count;
+	uint32_t dropped;
+} FLOG_Log_t;
+
+typedef void (*FLOG_Visitor_t)(uint8_t * record);
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef FLOG_Init(FLOG_Log_t * log, const STO_Device_t * device, uint32_t start, uint32_t size, uint16_t length, uint8_t * queue, uint16_t capacity);
+HAL_StatusTypeDef FLOG_Append(FLOG_Log_t * log, uint8_t * record);
+HAL_StatusTypeDef FLOG_Process(FLOG_Log_t * log);
+HAL_StatusTypeDef FLOG_Flush(FLOG_Log_t * log);
+HAL_StatusTypeDef FLOG_Export(FLOG_Log_t * log, FLOG_Visitor_t visitor);
+HAL_StatusTypeDef FLOG_getNewest(FLOG_Log_t * log, uint8_t * record);
+
+#endif /* INC_FLASHLOG_H_ */
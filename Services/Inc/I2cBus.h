@@ -0,0 +1,132 @@
+/*
+ * I2cBus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_I2CBUS_H_
+#define INC_I2CBUS_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define IIC_QUEUE_SIZE			8			// Transfers waiting for the bus
+#define IIC_NB_DEVICES			8			// Devices with statistics
+#define IIC_WRITE_MAX			32			// Longest write (Bytes after the register)
+#define IIC_DMA_MIN				2			// Shorter transfers are handled by interrupts
+
+#define IIC_TIMEOUT				10			// Longest transfer (ms), the bus is recovered after it
+#define IIC_RECOVERY_PULSES		9			// Clocks on SCL to release a slave holding SDA
+
+#define IIC_RISE_TIME			100			// Rise time of SCL and SDA on the board (ns)
+#define IIC_FALL_TIME			10			// Fall time of SCL and SDA on the board (ns)
+#define IIC_PROBE_READS			2			// Reads a device must answer to keep a speed
+
+//Pins of I2C1 (see HAL_I2C_MspInit)
+#define IIC_SCL_PORT			GPIOA
+#define IIC_SCL_PIN				GPIO_PIN_15
+#define IIC_SDA_PORT			GPIOB
+#define IIC_SDA_PIN				GPIO_PIN_7
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	IIC_WRITE	= 0,
+	IIC_READ	= 1
+}IIC_Direction_t;
+
+typedef enum
+{
+	IIC_STANDARD	= 100000,	// Standard-mode (Hz)
+	IIC_FAST		= 400000,	// Fast-mode (Hz)
+	IIC_FAST_PLUS	= 1000000	// Fast-mode Plus (Hz)
+}IIC_Speed_t;
+
+typedef struct IIC_Transfer IIC_Transfer_t;
+typedef void (*IIC_Callback_t)(IIC_Transfer_t * transfer);
+
+/*
+ * IIC_Transfer_t definition
+ * Register access queued on I2C1, the structure must stay valid until done is set
+ * address		: Address of the device, shifted as for the HAL (RTC_addr)
+ * reg			: First register
+ * direction	: IIC_READ or IIC_WRITE
+ * data			: Bytes read or written
+ * length		: Number of Bytes (up to IIC_WRITE_MAX for a write)
+ * callback		: Function called from the interrupt when the transfer is over, NULL if none
+ * status		: Result of the transfer (HAL_OK, HAL_ERROR on a NACK or a bus error, HAL_TIMEOUT)
+ * done			: Set when the transfer is over
+ */
+struct IIC_Transfer
+{
+	uint16_t address;
+	uint8_t reg;
+	IIC_Direction_t direction;
+	uint8_t * data;
+	uint16_t length;
+	IIC_Callback_t callback;
+	volatile HAL_StatusTypeDef status;
+	volatile uint8_t done;
+};
+
+/*
+ * IIC_Stats_t definition
+ * Statistics of a device since the reset
+ * address		: Address of the device
+ * speed		: Bus frequency used with the device (IIC_Speed_t, see IIC_Probe)
+ * transfers	: Transfers completed without error
+ * bytes		: Data Bytes of these transfers
+ * nacks		: Transfers not acknowledged
+ * errors		: Bus errors (arbitration lost, misplaced start/stop, DMA)
+ * timeouts		: Transfers aborted after IIC_TIMEOUT
+ */
+typedef struct
+{
+	uint16_t address;
+	IIC_Speed_t speed;
+	uint32_t transfers;
+	uint32_t bytes;
+	uint32_t nacks;
+	uint32_t errors;
+	uint32_t timeouts;
+} IIC_Stats_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IIC_Init(void);
+
+HAL_StatusTypeDef IIC_Submit(IIC_Transfer_t * transfer);
+void IIC_Process(void);
+
+HAL_StatusTypeDef IIC_Read(uint16_t address, uint8_t reg, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef IIC_Write(uint16_t address, uint8_t reg, uint8_t * data, uint16_t length);
+
+HAL_StatusTypeDef IIC_Recover(void);
+
+HAL_StatusTypeDef IIC_getTiming(uint32_t clock, IIC_Speed_t speed, uint32_t rise, uint32_t fall, uint32_t * timing);
+HAL_StatusTypeDef IIC_Probe(uint16_t address, IIC_Speed_t speed);
+
+HAL_StatusTypeDef IIC_getStats(uint16_t address, IIC_Stats_t * stats);
+uint32_t IIC_getRecoveries(void);
+
+void IIC_EventIRQHandler(void);
+void IIC_ErrorIRQHandler(void);
+void IIC_TxIRQHandler(void);
+void IIC_RxIRQHandler(void);
+
+#endif /* INC_I2CBUS_H_ */
@@ -0,0 +1,54 @@
+/*
+ * InternalFlash.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_INTERNALFLASH_H_
+#define INC_INTERNALFLASH_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "Storage.h"
+#include "FlashLog.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define IFL_SIZE_PAGE			FLASH_PAGE_SIZE		// Erase unit of the internal flash (2 KB)
+#define IFL_QUEUE_RECORDS		32			// Records waiting to be programmed (a page of the sample log)
+
+/*
+ * OVERFLOW TIER
+ * Section .logflash of the linker script (LOGFLASH, second half of the internal flash), used as a
+ * flash log (see FlashLog.h) of 2 KB sectors. The records of the oldest page of the sample log are
+ * moved there before the page is overwritten (see LOG_setOverflow).
+ * A program or an erase stalls the CPU while it reads the flash (up to 40 ms for an erase).
+ */
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IFL_Init(void);
+const STO_Device_t * IFL_getDevice(void);
+FLOG_Log_t * IFL_getLog(void);
+
+HAL_StatusTypeDef IFL_Read(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef IFL_Program(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef IFL_Erase(uint32_t addr);
+uint8_t IFL_isBusy(void);
+
+#endif /* INC_INTERNALFLASH_H_ */
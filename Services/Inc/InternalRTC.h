@@ -0,0 +1,51 @@
+/*
+ * InternalRTC.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_INTERNALRTC_H_
+#define INC_INTERNALRTC_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "RTC.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define IRTC_SYNC_PERIOD		3600UL		// Interval between two synchronizations with the DS1307 (s)
+#define IRTC_WAKEUP_PERIOD		1			// Default interval of the wake-up timer (s)
+#define IRTC_WAKEUP_OFF			0
+
+#define IRTC_TIMEOUT			100			// Timeout of the initialization mode of the RTC (ms)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IRTC_Init(void);
+
+uint32_t IRTC_getTimestamp(void);
+HAL_StatusTypeDef IRTC_setTimestamp(uint32_t timestamp);
+
+uint8_t IRTC_isSyncDue(uint32_t timestamp);
+HAL_StatusTypeDef IRTC_Sync(void);
+int32_t IRTC_getDrift(void);
+
+HAL_StatusTypeDef IRTC_setWakeUp(uint16_t period);
+void IRTC_Sleep(void);
+void IRTC_IRQHandler(void);
+
+#endif /* INC_INTERNALRTC_H_ */
@@ -0,0 +1,43 @@
+/*
+ * LogIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_LOGINDEX_H_
+#define INC_LOGINDEX_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <string.h>
+#include "main.h"
+#include "DataLog.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define IDX_EMPTY				0xFFFFFFFF	// Timestamp read in a page never written (erased EEPROM)
+
+#define IDX_PAGES(size)			((size) / EE_SIZE_PAGE)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IDX_Build(LOG_Ring_t * ring, uint16_t length);
+void IDX_Update(LOG_Ring_t * ring, uint32_t addr, uint8_t * data);
+
+uint32_t IDX_Find(LOG_Ring_t * ring, uint32_t timestamp);
+uint8_t IDX_isOrdered(LOG_Ring_t * ring);
+
+#endif /* INC_LOGINDEX_H_ */
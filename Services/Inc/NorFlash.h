@@ -0,0 +1,83 @@
+/*
+ * NorFlash.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_NORFLASH_H_
+#define INC_NORFLASH_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "Storage.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define NOR_SIZE_PAGE			0x100		// Largest program of one command (256 Bytes)
+#define NOR_SIZE_SECTOR			0x1000		// Smallest erase (4 KB)
+#define NOR_SIZE_3BYTES			0x1000000	// Largest part addressed with 3 Bytes (16 MB)
+
+#define NOR_TIMEOUT_PAGE		5			// Longest program of a page (ms)
+#define NOR_TIMEOUT_ERASE		400			// Longest erase of a sector (ms)
+
+//Chip select of the flash, SPI2 is shared with the EEPROM (see EE_Select)
+#define NOR_CS_PORT				GPIOC
+#define NOR_CS_PIN				GPIO_PIN_8
+
+#define NOR_CAPACITY_MIN		0x11		// JEDEC capacity codes accepted (2^n Bytes, 128 KB to 64 MB)
+#define NOR_CAPACITY_MAX		0x1A
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	NOR_WREN	= 0x06,		// Write Enable
+	NOR_RDSR	= 0x05,		// Read Status Register 1 (bit 0 : WIP)
+	NOR_READ	= 0x03,		// Read Data, 3 address Bytes
+	NOR_PP		= 0x02,		// Page Program, 3 address Bytes
+	NOR_SE		= 0x20,		// Sector Erase 4 KB, 3 address Bytes
+	NOR_READ4	= 0x13,		// Read Data, 4 address Bytes
+	NOR_PP4		= 0x12,		// Page Program, 4 address Bytes
+	NOR_SE4		= 0x21,		// Sector Erase 4 KB, 4 address Bytes
+	NOR_RDID	= 0x9F,		// Read JEDEC ID
+	NOR_RES		= 0xAB		// Release from Deep Power-Down
+}NOR_opcode_t;
+
+/*
+ * NOR_ID_t definition
+ * JEDEC ID of the flash
+ * manufacturer	: JEDEC manufacturer (0xEF Winbond, 0xC2 Macronix, 0x20 Micron...)
+ * type			: Memory type
+ * capacity		: Capacity code, the size is 2^capacity Bytes
+ */
+typedef struct
+{
+	uint8_t manufacturer;
+	uint8_t type;
+	uint8_t capacity;
+} NOR_ID_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef NOR_Init(void);
+void NOR_getID(NOR_ID_t * id);
+const STO_Device_t * NOR_getDevice(void);
+
+HAL_StatusTypeDef NOR_Read(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef NOR_Program(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef NOR_Erase(uint32_t addr);
+uint8_t NOR_isBusy(void);
+
+#endif /* INC_NORFLASH_H_ */
@@ -19,10 +19,13 @@
  * PUBLIC CONSTANT
  */
 #define RTC_addr	(0x68&0xFF)<<1
+#define RTC_SPEED	IIC_STANDARD	// Fastest mode of the DS1307
 
 #define HOUR_TYPE_24H	0
 #define HOUR_TYPE_12H	1
 
+#define RTC_SECONDS_PER_DAY		86400UL		// Timestamps are counted in seconds since 01/01/2000 00:00:00
+
 
 /*
  * PUBLIC TYPE DEFINITION
@@ -118,4 +121,12 @@ HAL_StatusTypeDef RTC_setHour(uint8_t hour, uint8_t hourMode, TIME_12H_t time);
 HAL_StatusTypeDef RTC_setMinutes(uint8_t minutes);
 HAL_StatusTypeDef RTC_setSeconds(uint8_t seconds);
 
+/***************************************************************************************/
+/************************************** CONVERSION *************************************/
+/***************************************************************************************/
+uint32_t RTC_toTimestamp(RTC_Date_t * RTC_Date);
+void RTC_fromTimestamp(uint32_t timestamp, RTC_Date_t * RTC_Date);
+uint8_t bcd2bin(uint8_t value);
+uint8_t bin2bcd(uint8_t value);
+
 #endif /* INC_RTC_H_ */
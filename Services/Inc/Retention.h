@@ -0,0 +1,75 @@
+/*
+ * Retention.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_RETENTION_H_
+#define INC_RETENTION_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "main.h"
+#include "DataLog.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define RET_ROLLUP_SIZE			sizeof(RET_Rollup_t)
+
+#define RET_HOUR				3600UL		// Length of an hourly rollup (s)
+#define RET_DAY					RTC_SECONDS_PER_DAY
+
+#define RET_FLAG_PARTIAL		0x01		// The period was not observed from its beginning (reset)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef enum
+{
+	RET_TIER_HOURLY	= 0,
+	RET_TIER_DAILY	= 1
+}RET_Tier_t;
+
+/*
+ * RET_Rollup_t definition
+ * Summary of the samples of one period, 16 Bytes (15 rollups per EEPROM page)
+ * timestamp	: Start of the period in seconds since 01/01/2000 00:00:00
+ * min			: Lowest sample of the period
+ * max			: Highest sample of the period
+ * sum			: Sum of the samples of the period (mean = sum / count)
+ * count		: Number of samples of the period
+ * channel		: Bitmap of the channel(s) of the samples (LOG_CHANNEL_xxx)
+ * flags		: RET_FLAG_xxx
+ */
+typedef struct
+{
+	uint32_t timestamp;
+	int16_t min;
+	int16_t max;
+	int32_t sum;
+	uint16_t count;
+	uint8_t channel;
+	uint8_t flags;
+} RET_Rollup_t;
+
+typedef void (*RET_Callback_t)(RET_Rollup_t * rollup);
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef RET_Init(const STO_Device_t * device);
+
+HAL_StatusTypeDef RET_Add(uint32_t timestamp, int16_t value);
+
+HAL_StatusTypeDef RET_Export(RET_Tier_t tier, RET_Callback_t callback);
+
+#endif /* INC_RETENTION_H_ */
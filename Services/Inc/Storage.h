@@ -0,0 +1,97 @@
+/*
+ * Storage.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_STORAGE_H_
+#define INC_STORAGE_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include "stm32f3xx_hal.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define STO_NO_ERASE			0			// Sector size of a device written in place (EEPROM)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+typedef uint8_t (*STO_Callback_t)(uint8_t * data, uint16_t length);
+
+/*
+ * STO_Device_t definition
+ * Block storage device used by the log, the index and the retention tiers.
+ * The addresses go from 0 to size - 1, the accesses beyond are refused by the STO_ functions.
+ * size		: Capacity of the device (Bytes)
+ * page		: Largest program of one command, a program must not cross a page (the driver splits it)
+ * sector	: Erase unit (Bytes), STO_NO_ERASE if the device is written in place
+ * read		: Read Bytes
+ * program	: Program Bytes, which must be erased first if sector is not STO_NO_ERASE
+ * stream	: Read a long range by chunks (see EE_Stream), NULL to read it with read
+ * isBusy	: 1 while a program or an erase is in progress
+ * erase	: Erase the sector of an address, NULL if sector is STO_NO_ERASE
+ */
+typedef struct
+{
+	uint32_t size;
+	uint16_t page;
+	uint32_t sector;
+	HAL_StatusTypeDef (*read)(uint32_t addr, uint8_t * data, uint16_t length);
+	HAL_StatusTypeDef (*program)(uint32_t addr, uint8_t * data, uint16_t length);
+	HAL_StatusTypeDef (*stream)(uint32_t addr, uint32_t length, uint8_t * buffer, uint16_t size, STO_Callback_t callback);
+	uint8_t (*isBusy)(void);
+	HAL_StatusTypeDef (*erase)(uint32_t addr);
+} STO_Device_t;
+
+/*
+ * STO_Stats_t definition
+ * Accesses to the devices since the reset (or since STO_ResetStats), to benchmark the layers above
+ * reads		: Read and stream commands
+ * readBytes	: Bytes read
+ * programs		: Program commands
+ * programBytes	: Bytes programmed
+ * erases		: Sectors erased
+ */
+typedef struct
+{
+	uint32_t reads;
+	uint32_t readBytes;
+	uint32_t programs;
+	uint32_t programBytes;
+	uint32_t erases;
+} STO_Stats_t;
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+#ifndef STO_HOST
+extern const STO_Device_t STO_Eeprom;
+#endif
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef STO_Read(const STO_Device_t * device, uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef STO_Program(const STO_Device_t * device, uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef STO_Stream(const STO_Device_t * device, uint32_t addr, uint32_t length, uint8_t * buffer, uint16_t size, STO_Callback_t callback);
+HAL_StatusTypeDef STO_Erase(const STO_Device_t * device, uint32_t addr);
+uint8_t STO_isBusy(const STO_Device_t * device);
+void STO_Count(const STO_Device_t * device, uint32_t addr, uint32_t length);
+
+void STO_getStats(STO_Stats_t * stats);
+void STO_ResetStats(void);
+
+#ifdef STO_HOST
+const STO_Device_t * STO_FileOpen(const char * path, uint32_t size, uint16_t page, uint32_t sector);
+void STO_FileClose(void);
+uint32_t STO_FileGetErrors(void);
+#endif
+
+#endif /* INC_STORAGE_H_ */
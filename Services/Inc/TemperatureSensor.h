@@ -17,6 +17,8 @@
 /*
  * PUBLIC CONSTANT
  */
+#define TS_ADC_FULL_SCALE		4095		// 12 bits
+#define TS_VDDA_CAL				3300		// VDDA of the factory calibration (mV)
 
 /*
  * PUBLIC GLOBAL VARIABLE
@@ -25,6 +27,13 @@
 /*
  * PUBLIC FUNCTION PROTOTYPES
  */
-uint32_t TS_getTemperature(void);
+HAL_StatusTypeDef TS_Init(void);
+
+HAL_StatusTypeDef TS_getTemperature(int16_t * temperature);
+
+int16_t TS_toTemperature(uint16_t raw, uint16_t vrefint);
+int16_t TS_toMcuTemperature(uint16_t raw, uint16_t vrefint);
+uint16_t TS_toVdda(uint16_t vrefint);
+uint16_t TS_toVbat(uint16_t raw, uint16_t vrefint);
 
 #endif /* INC_TEMPERATURESENSOR_H_ */
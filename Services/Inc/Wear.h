@@ -0,0 +1,60 @@
+/*
+ * Wear.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+#ifndef INC_WEAR_H_
+#define INC_WEAR_H_
+
+/*
+ * INCLUDE FILES
+ */
+#include <stddef.h>
+#include <string.h>
+#include "main.h"
+
+/*
+ * PUBLIC CONSTANT
+ */
+#define WEAR_BLOCK_PAGES		16			// Pages sharing one program counter (4 KB)
+#define WEAR_BLOCK_SIZE			(WEAR_BLOCK_PAGES * EE_SIZE_PAGE)
+#define WEAR_NB_BLOCKS			((EE_LAST_PAGE + 1) / WEAR_BLOCK_PAGES)	// 128 counters
+
+#define WEAR_ENDURANCE			1000000UL	// Program cycles of a page guaranteed by the datasheet
+#define WEAR_SAVE_PROGRAMS		256			// Page programs between two saves of the counters
+#define WEAR_UNKNOWN			0xFFFFFFFF	// Lifetime not known yet (no program counted)
+
+/*
+ * WEAR REGION
+ * Ring of slots, each one holds a whole copy of the counters (see WEAR_Table_t in Wear.c).
+ * The slot with the highest sequence and a valid CRC is loaded on reset.
+ */
+#define WEAR_SLOT_SIZE			(3 * EE_SIZE_PAGE)
+
+
+/*
+ * PUBLIC TYPE DEFINITION
+ */
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+
+/*
+ * PUBLIC FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef WEAR_Init(uint32_t start, uint32_t size);
+void WEAR_Count(uint16_t page);
+HAL_StatusTypeDef WEAR_Process(void);
+HAL_StatusTypeDef WEAR_Save(void);
+
+uint32_t WEAR_getCount(uint16_t block);
+uint32_t WEAR_getHottest(uint16_t * block);
+uint32_t WEAR_getLifetime(uint32_t timestamp);
+
+uint32_t WEAR_Allocate(uint32_t start, uint32_t size, uint32_t length);
+
+#endif /* INC_WEAR_H_ */
@@ -0,0 +1,255 @@
+/*
+ * Acquisition.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Acquisition.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+ACQ_Config_t ACQ_Config;
+
+uint8_t ACQ_Rate = 0;					// Index of the sampling rate in use
+uint32_t ACQ_NextSample = 0;			// Timestamp of the next sample
+uint8_t ACQ_StableCount = 0;			// Number of consecutive samples under slopeDown
+
+uint16_t ACQ_BudgetUsed[ACQ_NB_RATES];	// Samples taken at each rate in the current window
+uint32_t ACQ_BudgetWindow = 0;			// Start of the current budget window
+
+uint32_t ACQ_RefTimestamp;				// Sample at the start of the slope window
+int16_t ACQ_RefValue;
+uint32_t ACQ_NextRefTimestamp;			// Sample which starts the next slope window
+int16_t ACQ_NextRefValue;
+uint8_t ACQ_HasLastValue = 0;
+uint32_t ACQ_RateTimestamp = 0;			// Time of the last change of rate
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void ACQ_SetRate(uint8_t rate, uint32_t timestamp);
+uint8_t ACQ_isBudgetLeft(uint8_t rate);
+
+
+/***************************************************************************************/
+/*
+ * ACQ_Init
+ * @brief
+ * Initialize the acquisition scheduler on the slowest rate
+ * @param
+ * config : Sampling rates, budgets and slope thresholds
+ * @return
+ * none
+ */
+void ACQ_Init(ACQ_Config_t config)
+{
+	ACQ_Config = config;
+
+	ACQ_Rate = 0;
+	ACQ_NextSample = 0;
+	ACQ_StableCount = 0;
+	ACQ_HasLastValue = 0;
+	ACQ_BudgetWindow = 0;
+	ACQ_RateTimestamp = 0;
+
+	for(uint8_t i = 0; i < ACQ_NB_RATES; i++)
+	{
+		ACQ_BudgetUsed[i] = 0;
+	}
+}
+
+/*
+ * ACQ_isSampleDue
+ * @brief
+ * Check if a sample has to be taken.
+ * The samples are aligned on multiples of the period (every minute at 0 second for a period of 60 s).
+ * @param
+ * timestamp : Current time in seconds since 01/01/2000 00:00:00
+ * @return
+ * uint8_t	: 	0 = Nothing to do
+ * 				1 = A sample has to be taken
+ */
+uint8_t ACQ_isSampleDue(uint32_t timestamp)
+{
+	uint32_t period = ACQ_Config.rate[ACQ_Rate].period;
+
+	//A schedule more than one period ahead means that the clock went back
+	if(timestamp < ACQ_NextSample && ACQ_NextSample - timestamp <= period)
+	{
+		return 0;
+	}
+
+	ACQ_NextSample = (timestamp / period + 1) * period;
+
+	//The first call only synchronizes the schedule on the period
+	return ACQ_HasLastValue || (timestamp % period) == 0;
+}
+
+/*
+ * ACQ_Update
+ * @brief
+ * Give the new sample to the scheduler.
+ * The slope is measured from a sample one to two periods of the slowest rate old (one period at least
+ * after a reset), so the noise of a single sample is spread over the whole window. It selects the next rate :
+ * - above slopeUp, the next faster rate is used, if the current one has been in use for a whole window
+ * - under slopeDown for holdCount samples, the next slower rate is used
+ * Between slopeDown and slopeUp, the rate is kept.
+ * A rate without budget left in the current window is left for the next slower one.
+ * @param
+ * timestamp	:	Time of the sample in seconds since 01/01/2000 00:00:00
+ * value		:	Value of the sample
+ * @return
+ * none
+ */
+void ACQ_Update(uint32_t timestamp, int16_t value)
+{
+	int32_t slope = 0;
+	uint8_t rate = ACQ_Rate;
+	uint32_t window = ACQ_Config.rate[0].period;
+	uint32_t elapsed;
+
+	if(timestamp - ACQ_BudgetWindow >= ACQ_BUDGET_WINDOW)
+	{
+		ACQ_BudgetWindow = timestamp;
+		for(uint8_t i = 0; i < ACQ_NB_RATES; i++)
+		{
+			ACQ_BudgetUsed[i] = 0;
+		}
+	}
+	ACQ_BudgetUsed[ACQ_Rate]++;
+
+	if(ACQ_HasLastValue && timestamp > ACQ_RefTimestamp)
+	{
+		//Slope in sensor unit per minute over one window at least
+		elapsed = timestamp - ACQ_RefTimestamp;
+		if(elapsed < window)
+		{
+			elapsed = window;
+		}
+		slope = ((int32_t)value - ACQ_RefValue) * 60 / (int32_t)elapsed;
+		if(slope < 0)
+		{
+			slope = -slope;
+		}
+
+		if(slope > ACQ_Config.slopeUp)
+		{
+			ACQ_StableCount = 0;
+			if(rate < ACQ_NB_RATES - 1 && timestamp - ACQ_RateTimestamp >= window && ACQ_isBudgetLeft(rate + 1))
+			{
+				rate++;
+			}
+		}
+		else if(slope < ACQ_Config.slopeDown)
+		{
+			ACQ_StableCount++;
+			if(ACQ_StableCount >= ACQ_Config.holdCount && rate > 0)
+			{
+				ACQ_StableCount = 0;
+				rate--;
+			}
+		}
+		else
+		{
+			ACQ_StableCount = 0;
+		}
+	}
+
+	while(rate > 0 && !ACQ_isBudgetLeft(rate))
+	{
+		rate--;
+	}
+
+	if(rate != ACQ_Rate)
+	{
+		ACQ_SetRate(rate, timestamp);
+	}
+
+	//The window slides by whole windows, it starts again if the clock went back
+	if(!ACQ_HasLastValue || timestamp < ACQ_RefTimestamp)
+	{
+		ACQ_RefTimestamp = timestamp;
+		ACQ_RefValue = value;
+		ACQ_NextRefTimestamp = timestamp;
+		ACQ_NextRefValue = value;
+	}
+	else if(timestamp - ACQ_NextRefTimestamp >= window)
+	{
+		ACQ_RefTimestamp = ACQ_NextRefTimestamp;
+		ACQ_RefValue = ACQ_NextRefValue;
+		ACQ_NextRefTimestamp = timestamp;
+		ACQ_NextRefValue = value;
+	}
+	ACQ_HasLastValue = 1;
+}
+
+/*
+ * ACQ_getRate
+ * @brief
+ * Get the index of the sampling rate in use
+ * @param
+ * none
+ * @return
+ * uint8_t : Index of the rate, 0 is the slowest
+ */
+uint8_t ACQ_getRate(void)
+{
+	return ACQ_Rate;
+}
+
+/*
+ * ACQ_getPeriod
+ * @brief
+ * Get the period of the sampling rate in use
+ * @param
+ * none
+ * @return
+ * uint32_t : Time between two samples (s)
+ */
+uint32_t ACQ_getPeriod(void)
+{
+	return ACQ_Config.rate[ACQ_Rate].period;
+}
+
+/*
+ * ACQ_SetRate
+ * @brief
+ * Change the sampling rate and schedule the next sample on the new period
+ * @param
+ * rate			:	Index of the new rate
+ * timestamp	:	Time of the last sample
+ * @return
+ * none
+ */
+void ACQ_SetRate(uint8_t rate, uint32_t timestamp)
+{
+	ACQ_Rate = rate;
+	ACQ_StableCount = 0;
+	ACQ_RateTimestamp = timestamp;
+	ACQ_NextSample = (timestamp / ACQ_Config.rate[rate].period + 1) * ACQ_Config.rate[rate].period;
+}
+
+/*
+ * ACQ_isBudgetLeft
+ * @brief
+ * Check if samples can still be taken at a rate in the current budget window
+ * @param
+ * rate : Index of the rate
+ * @return
+ * uint8_t	: 	0 = Budget exhausted
+ * 				1 = Budget left
+ */
+uint8_t ACQ_isBudgetLeft(uint8_t rate)
+{
+	return ACQ_Config.rate[rate].budget == ACQ_BUDGET_UNLIMITED || ACQ_BudgetUsed[rate] < ACQ_Config.rate[rate].budget;
+}
@@ -0,0 +1,754 @@
+/*
+ * AdcStream.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "AdcStream.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define AS_ARR_MAX				0x10000UL	// TIM3 is a 16 bits timer
+
+//Channels of the scan, in the order of the bits of LOG_CHANNEL_xxx
+const uint32_t AS_AdcChannel[AS_NB_CHANNELS] = {ADC_CHANNEL_1, ADC_CHANNEL_TEMPSENSOR, ADC_CHANNEL_VREFINT, ADC_CHANNEL_VBAT};
+
+//The internal channels need a sampling time of at least 2.2 us
+const uint32_t AS_SamplingTime[AS_NB_CHANNELS] = {ADC_SAMPLETIME_4CYCLES_5, ADC_SAMPLETIME_181CYCLES_5, ADC_SAMPLETIME_181CYCLES_5, ADC_SAMPLETIME_181CYCLES_5};
+const uint16_t AS_ConversionCycles[AS_NB_CHANNELS] = {17, 194, 194, 194};	// Sampling + 12.5 cycles, rounded up
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+TIM_HandleTypeDef AS_htim2;				// Timebase of the timestamps, captures the triggers of TIM3
+TIM_HandleTypeDef AS_htim3;				// Sample clock, triggers ADC1 and drives ADC1_VCC (channel 1)
+DMA_HandleTypeDef AS_hdma;
+
+ADC_InitTypeDef AS_AdcInit;				// Configuration of ADC1 made by MX_ADC1_Init, restored after each use
+
+uint16_t AS_Buffer[AS_BUFFER_SIZE];
+AS_Callback_t AS_UserCallback;
+FLT_Filter_t * AS_Filter[AS_NB_CHANNELS];	// Filter of each channel, in the order of the bits
+uint8_t AS_Running = 0;
+
+uint8_t AS_Channels;					// Bitmap of the channels of the stream
+uint8_t AS_Width;						// Number of channels of the stream
+uint16_t AS_Scans;						// Scans of each half of the buffer
+
+uint32_t AS_Settle;						// Settling time of the sensor (us), AS_EXCITATION_ALWAYS when not switched
+uint32_t AS_Delay;						// Time from the start of TIM3 to the first trigger (us)
+
+uint32_t AS_Period;						// Interval between two scans (us)
+uint32_t AS_Index;						// Number of the first scan of the next block
+uint32_t AS_RefTime;					// Time and number of a known trigger
+uint32_t AS_RefIndex;
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint32_t AS_TimerClock(void);
+uint32_t AS_Cycles(uint8_t channels);
+HAL_StatusTypeDef AS_Clock(uint32_t period, uint32_t conversion, uint8_t single);
+HAL_StatusTypeDef AS_Wait(uint32_t timeout);
+HAL_StatusTypeDef AS_Configure(uint8_t channels, uint32_t trigger);
+HAL_StatusTypeDef AS_Restore(void);
+void AS_Deliver(uint16_t * samples);
+
+
+/***************************************************************************************/
+/*
+ * AS_Init
+ * @brief
+ * Initialize the timers and the DMA of the sample stream.
+ * TIM2 runs freely at AS_TIMEBASE and its channel 1 captures the trigger output of TIM3 (ITR2),
+ * so that the time of the last trigger of ADC1 is always known.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Init(void)
+{
+	TIM_SlaveConfigTypeDef sSlaveConfig = {0};
+	TIM_IC_InitTypeDef sConfigIC = {0};
+
+	__HAL_RCC_TIM2_CLK_ENABLE();
+	__HAL_RCC_TIM3_CLK_ENABLE();
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	//Timebase of the timestamps
+	AS_htim2.Instance = TIM2;
+	AS_htim2.Init.Prescaler = AS_TimerClock() / AS_TIMEBASE - 1;
+	AS_htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+	AS_htim2.Init.Period = 0xFFFFFFFF;
+	AS_htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	AS_htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if(HAL_TIM_IC_Init(&AS_htim2) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	sSlaveConfig.SlaveMode = TIM_SLAVEMODE_DISABLE;
+	sSlaveConfig.InputTrigger = TIM_TS_ITR2;
+	if(HAL_TIM_SlaveConfigSynchro(&AS_htim2, &sSlaveConfig) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	sConfigIC.ICPolarity = TIM_INPUTCHANNELPOLARITY_RISING;
+	sConfigIC.ICSelection = TIM_ICSELECTION_TRC;
+	sConfigIC.ICPrescaler = TIM_ICPSC_DIV1;
+	sConfigIC.ICFilter = 0;
+	if(HAL_TIM_IC_ConfigChannel(&AS_htim2, &sConfigIC, TIM_CHANNEL_1) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	//ADC1 -> DMA1 Channel 1, circular buffer
+	AS_hdma.Instance = DMA1_Channel1;
+	AS_hdma.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	AS_hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+	AS_hdma.Init.MemInc = DMA_MINC_ENABLE;
+	AS_hdma.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+	AS_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+	AS_hdma.Init.Mode = DMA_CIRCULAR;
+	AS_hdma.Init.Priority = DMA_PRIORITY_HIGH;
+	if(HAL_DMA_Init(&AS_hdma) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	__HAL_LINKDMA(&hadc1, DMA_Handle, AS_hdma);
+
+	HAL_NVIC_SetPriority(DMA1_Channel1_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+	AS_AdcInit = hadc1.Init;
+	AS_Settle = AS_EXCITATION_ALWAYS;
+	AS_Running = 0;
+
+	return HAL_TIM_IC_Start(&AS_htim2, TIM_CHANNEL_1);
+}
+
+/*
+ * AS_Start
+ * @brief
+ * Start the scans of ADC1 triggered by TIM3.
+ * Each trigger converts the whole channel list, the samples are interleaved in the DMA buffer
+ * and given by blocks of whole scans to the callback, from the DMA interrupt.
+ * When the excitation is switched (see AS_setExcitation), it is on for the settling time and the scan of each period only.
+ * The period is rounded to a whole number of us (see AS_getPeriod).
+ * @param
+ * rate		:	Scan rate in Hz (AS_RATE_MIN to AS_RATE_MAX, limited by the conversion time of the list)
+ * channels	:	Bitmap of the channels to convert (LOG_CHANNEL_xxx)
+ * callback	:	Function called for each block of scans
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Start(uint32_t rate, uint8_t channels, AS_Callback_t callback)
+{
+	uint32_t cycles, clock = HAL_RCC_GetSysClockFreq();
+
+	if(AS_Running || rate < AS_RATE_MIN || rate > AS_RATE_MAX || callback == NULL)
+	{
+		return HAL_ERROR;
+	}
+
+	//The scan must be over before the next trigger (ADC1 clocked by the PLL)
+	cycles = AS_Cycles(channels);
+	if(cycles == 0 || (uint64_t)cycles * rate >= clock)
+	{
+		return HAL_ERROR;
+	}
+
+	if(AS_Clock(AS_TIMEBASE / rate, ((uint64_t)cycles * AS_TIMEBASE + clock - 1) / clock, 0) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	//ADC1 converts the list once on each trigger of TIM3, each half of the buffer holds whole scans
+	if(AS_Configure(channels, ADC_EXTERNALTRIGCONV_T3_TRGO) != HAL_OK)
+	{
+		AS_Restore();
+		return HAL_ERROR;
+	}
+	AS_Channels = channels;
+	AS_Width = hadc1.Init.NbrOfConversion;
+	AS_Scans = AS_BUFFER_SIZE / 2 / AS_Width;
+
+	if(HAL_ADC_Start_DMA(&hadc1, (uint32_t *)AS_Buffer, 2 * AS_Scans * AS_Width) != HAL_OK)
+	{
+		AS_Restore();
+		return HAL_ERROR;
+	}
+
+	AS_UserCallback = callback;
+	AS_Index = 0;
+	AS_RefIndex = 0;
+
+	//The first trigger happens one period, or one settling time, after the start of TIM3
+	__HAL_TIM_SET_COUNTER(&AS_htim3, 0);
+	AS_RefTime = AS_getTime() + AS_Delay;
+	AS_Running = 1;
+
+	if(AS_Settle == AS_EXCITATION_ALWAYS)
+	{
+		return HAL_TIM_Base_Start(&AS_htim3);
+	}
+
+	return HAL_TIM_PWM_Start(&AS_htim3, TIM_CHANNEL_1);
+}
+
+/*
+ * AS_Stop
+ * @brief
+ * Stop the sample clock and give ADC1 back its configuration of MX_ADC1_Init
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Stop(void)
+{
+	if(!AS_Running)
+	{
+		return HAL_OK;
+	}
+
+	if(AS_Settle == AS_EXCITATION_ALWAYS)
+	{
+		HAL_TIM_Base_Stop(&AS_htim3);
+	}
+	else
+	{
+		//The output of channel 1 is disabled, the pull-down keeps the excitation off
+		HAL_TIM_PWM_Stop(&AS_htim3, TIM_CHANNEL_1);
+	}
+	HAL_ADC_Stop_DMA(&hadc1);
+	AS_Running = 0;
+
+	return AS_Restore();
+}
+
+/*
+ * AS_Read
+ * @brief
+ * Convert the channel list once.
+ * The board health (internal temperature, VREFINT, VBAT) is read with the external sensor in one scan.
+ * When the excitation is switched, one pulse of TIM3 powers the sensor and triggers the scan
+ * after the settling time, the core sleeps until the end of the sequence.
+ * Otherwise the scan is started by software.
+ * Not available while the stream runs.
+ * @param
+ * channels	:	Bitmap of the channels to convert (LOG_CHANNEL_xxx)
+ * values	:	Raw conversions, one per channel in the order of the bits
+ * @return
+ * HAL_StatusTypeDef : Status of the conversion
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef AS_Read(uint8_t channels, uint16_t * values)
+{
+	HAL_StatusTypeDef state;
+	uint32_t conversion, clock = HAL_RCC_GetSysClockFreq();
+
+	if(AS_Running)
+	{
+		return HAL_BUSY;
+	}
+
+	if(AS_Settle == AS_EXCITATION_ALWAYS)
+	{
+		state = AS_Configure(channels, ADC_SOFTWARE_START);
+	}
+	else
+	{
+		//The pulse leaves room for the rounding of the compares
+		conversion = ((uint64_t)AS_Cycles(channels) * AS_TIMEBASE + clock - 1) / clock;
+		state = AS_Clock(2 * (AS_Settle + conversion) + 10, conversion, 1);
+		if(state == HAL_OK)
+		{
+			state = AS_Configure(channels, ADC_EXTERNALTRIGCONV_T3_TRGO);
+		}
+	}
+	if(state == HAL_OK)
+	{
+		state = HAL_ADC_Start_DMA(&hadc1, (uint32_t *)values, hadc1.Init.NbrOfConversion);
+	}
+	if(state == HAL_OK)
+	{
+		if(AS_Settle != AS_EXCITATION_ALWAYS)
+		{
+			state = HAL_TIM_PWM_Start(&AS_htim3, TIM_CHANNEL_1);
+		}
+		if(state == HAL_OK)
+		{
+			state = AS_Wait(AS_TIMEOUT + AS_Settle / 1000);
+		}
+		if(AS_Settle != AS_EXCITATION_ALWAYS)
+		{
+			HAL_TIM_PWM_Stop(&AS_htim3, TIM_CHANNEL_1);
+		}
+		HAL_ADC_Stop_DMA(&hadc1);
+	}
+
+	AS_Restore();
+
+	return state;
+}
+
+/*
+ * AS_setExcitation
+ * @brief
+ * Select how the excitation of the sensor (ADC1_VCC) is driven.
+ * With a settling time, ADC1_VCC is given to TIM3 channel 1 : the sensor is switched on at the start of each
+ * period, converted once it has settled and switched off at the end of the scan.
+ * A pull-down keeps it off while the timer is stopped.
+ * @param
+ * settle	:	Settling time in us (up to AS_SETTLE_MAX), AS_EXCITATION_ALWAYS to keep the sensor on
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY
+ */
+HAL_StatusTypeDef AS_setExcitation(uint32_t settle)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	if(AS_Running)
+	{
+		return HAL_BUSY;
+	}
+	if(settle > AS_SETTLE_MAX)
+	{
+		return HAL_ERROR;
+	}
+
+	GPIO_InitStruct.Pin = ADC1_VCC_Pin;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	if(settle == AS_EXCITATION_ALWAYS)
+	{
+		//As configured by MX_GPIO_Init
+		HAL_GPIO_WritePin(ADC1_VCC_GPIO_Port, ADC1_VCC_Pin, GPIO_PIN_SET);
+		GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+		GPIO_InitStruct.Pull = GPIO_NOPULL;
+	}
+	else
+	{
+		GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+		GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+		GPIO_InitStruct.Alternate = GPIO_AF2_TIM3;
+	}
+	HAL_GPIO_Init(ADC1_VCC_GPIO_Port, &GPIO_InitStruct);
+
+	AS_Settle = settle;
+
+	return HAL_OK;
+}
+
+/*
+ * AS_setFilter
+ * @brief
+ * Select the filter applied to a channel of the stream, before the blocks are given to the callback.
+ * The filter is reset so that its state is filled with the next sample.
+ * @param
+ * channel	:	One LOG_CHANNEL_xxx
+ * filter	:	Filter initialized by FLT_Init, NULL to give the raw conversions
+ * @return
+ * none
+ */
+void AS_setFilter(uint8_t channel, FLT_Filter_t * filter)
+{
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(channel & (1 << k))
+		{
+			if(filter != NULL)
+			{
+				FLT_Reset(filter);
+			}
+			AS_Filter[k] = filter;
+			return;
+		}
+	}
+}
+
+/*
+ * AS_getPeriod
+ * @brief
+ * Get the interval between two samples
+ * @param
+ * none
+ * @return
+ * uint32_t : Period of the sample clock (us)
+ */
+uint32_t AS_getPeriod(void)
+{
+	return AS_Period;
+}
+
+/*
+ * AS_getTime
+ * @brief
+ * Get the time of the timebase of the timestamps
+ * @param
+ * none
+ * @return
+ * uint32_t : Counter of TIM2 (us)
+ */
+uint32_t AS_getTime(void)
+{
+	return __HAL_TIM_GET_COUNTER(&AS_htim2);
+}
+
+/*
+ * AS_IRQHandler
+ * @brief
+ * Handle the interrupt of the DMA, called by DMA1_Channel1_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void AS_IRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&AS_hdma);
+}
+
+/*
+ * HAL_ADC_ConvHalfCpltCallback
+ * @brief
+ * First half of the DMA buffer filled
+ * @param
+ * hadc : ADC handle pointer
+ * @return
+ * none
+ */
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef * hadc)
+{
+	if(hadc->Instance == ADC1 && AS_Running)
+	{
+		AS_Deliver(&AS_Buffer[0]);
+	}
+}
+
+/*
+ * HAL_ADC_ConvCpltCallback
+ * @brief
+ * Second half of the DMA buffer filled
+ * @param
+ * hadc : ADC handle pointer
+ * @return
+ * none
+ */
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef * hadc)
+{
+	if(hadc->Instance == ADC1 && AS_Running)
+	{
+		AS_Deliver(&AS_Buffer[AS_Scans * AS_Width]);
+	}
+}
+
+/*
+ * AS_TimerClock
+ * @brief
+ * Get the clock of the timers of APB1 (TIM2, TIM3)
+ * @param
+ * none
+ * @return
+ * uint32_t : Frequency in Hz, twice PCLK1 when APB1 is divided
+ */
+uint32_t AS_TimerClock(void)
+{
+	uint32_t clock = HAL_RCC_GetPCLK1Freq();
+
+	if((RCC->CFGR & RCC_CFGR_PPRE1) != RCC_CFGR_PPRE1_DIV1)
+	{
+		clock *= 2;
+	}
+
+	return clock;
+}
+
+/*
+ * AS_Cycles
+ * @brief
+ * Get the conversion time of a scan
+ * @param
+ * channels	:	Bitmap of the channels to convert (LOG_CHANNEL_xxx)
+ * @return
+ * uint32_t : Cycles of ADC1
+ */
+uint32_t AS_Cycles(uint8_t channels)
+{
+	uint32_t cycles = 0;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(channels & (1 << k))
+		{
+			cycles += AS_ConversionCycles[k];
+		}
+	}
+
+	return cycles;
+}
+
+/*
+ * AS_Clock
+ * @brief
+ * Setup TIM3 as the sample clock.
+ * The prescaler is a multiple of 1 us so that the period stays a whole number of us.
+ * When the excitation is switched, channel 1 (ADC1_VCC) is high from the update to the end of the scan
+ * and the trigger of ADC1 is the rising edge of OC2REF, one settling time after the update.
+ * Otherwise ADC1 is triggered by the update.
+ * @param
+ * period		:	Interval between two triggers (us)
+ * conversion	:	Conversion time of a scan (us)
+ * single		:	Stop the counter after one period
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Clock(uint32_t period, uint32_t conversion, uint8_t single)
+{
+	TIM_MasterConfigTypeDef sMasterConfig = {0};
+	TIM_OC_InitTypeDef sConfigOC = {0};
+	uint32_t divider = period / AS_ARR_MAX + 1;
+	uint32_t trigger, off;
+
+	AS_htim3.Instance = TIM3;
+	AS_htim3.Init.Prescaler = (AS_TimerClock() / AS_TIMEBASE) * divider - 1;
+	AS_htim3.Init.CounterMode = TIM_COUNTERMODE_UP;
+	AS_htim3.Init.Period = period / divider - 1;
+	AS_htim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	AS_htim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+	if(HAL_TIM_PWM_Init(&AS_htim3) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	MODIFY_REG(AS_htim3.Instance->CR1, TIM_CR1_OPM, single ? TIM_CR1_OPM : 0);
+
+	AS_Period = divider * (AS_htim3.Init.Period + 1);
+	AS_Delay = AS_Period;
+	sMasterConfig.MasterOutputTrigger = TIM_TRGO_UPDATE;
+
+	if(AS_Settle != AS_EXCITATION_ALWAYS)
+	{
+		//The excitation goes off one tick after the end of the scan, before the next update
+		trigger = (AS_Settle + divider - 1) / divider;
+		off = trigger + (conversion + divider - 1) / divider + 1;
+		if(off > AS_htim3.Init.Period)
+		{
+			return HAL_ERROR;
+		}
+
+		sConfigOC.OCMode = TIM_OCMODE_PWM1;
+		sConfigOC.Pulse = off;
+		sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+		sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+		if(HAL_TIM_PWM_ConfigChannel(&AS_htim3, &sConfigOC, TIM_CHANNEL_1) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+
+		sConfigOC.OCMode = TIM_OCMODE_PWM2;
+		sConfigOC.Pulse = trigger;
+		if(HAL_TIM_PWM_ConfigChannel(&AS_htim3, &sConfigOC, TIM_CHANNEL_2) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+
+		//Load the preloaded compares for the first period, ADC1 is not armed yet
+		AS_htim3.Instance->EGR = TIM_EGR_UG;
+
+		sMasterConfig.MasterOutputTrigger = TIM_TRGO_OC2REF;
+		AS_Delay = trigger * divider;
+	}
+
+	sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
+
+	return HAL_TIMEx_MasterConfigSynchronization(&AS_htim3, &sMasterConfig);
+}
+
+/*
+ * AS_Wait
+ * @brief
+ * Wait for the end of the sequence of ADC1 in sleep mode, woken up by the DMA or the SysTick
+ * @param
+ * timeout	:	Timeout (ms)
+ * @return
+ * HAL_StatusTypeDef : Status of the conversion
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef AS_Wait(uint32_t timeout)
+{
+	uint32_t tickstart = HAL_GetTick();
+
+	while(!__HAL_ADC_GET_FLAG(&hadc1, ADC_FLAG_EOS))
+	{
+		if(HAL_GetTick() - tickstart > timeout)
+		{
+			return HAL_TIMEOUT;
+		}
+		HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+	}
+	__HAL_ADC_CLEAR_FLAG(&hadc1, ADC_FLAG_EOS);
+
+	return HAL_OK;
+}
+
+/*
+ * AS_Configure
+ * @brief
+ * Setup ADC1 to scan a channel list, the end of conversion is signaled at the end of the sequence.
+ * The internal channels are connected by HAL_ADC_ConfigChannel.
+ * @param
+ * channels	:	Bitmap of the channels to convert (LOG_CHANNEL_xxx)
+ * trigger	:	ADC_SOFTWARE_START for a single scan or ADC_EXTERNALTRIGCONV_xxx for the stream
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Configure(uint8_t channels, uint32_t trigger)
+{
+	ADC_ChannelConfTypeDef sConfig = {0};
+	uint8_t rank = 0;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(channels & (1 << k))
+		{
+			rank++;
+		}
+	}
+	if(rank == 0)
+	{
+		return HAL_ERROR;
+	}
+
+	hadc1.Init.ScanConvMode = ADC_SCAN_ENABLE;
+	hadc1.Init.ContinuousConvMode = DISABLE;
+	hadc1.Init.ExternalTrigConv = trigger;
+	hadc1.Init.ExternalTrigConvEdge = (trigger == ADC_SOFTWARE_START) ? ADC_EXTERNALTRIGCONVEDGE_NONE : ADC_EXTERNALTRIGCONVEDGE_RISING;
+	hadc1.Init.NbrOfConversion = rank;
+	hadc1.Init.DMAContinuousRequests = (trigger == ADC_SOFTWARE_START) ? DISABLE : ENABLE;
+	hadc1.Init.EOCSelection = ADC_EOC_SEQ_CONV;
+	hadc1.Init.Overrun = ADC_OVR_DATA_OVERWRITTEN;
+	if(HAL_ADC_Init(&hadc1) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	sConfig.SingleDiff = ADC_SINGLE_ENDED;
+	sConfig.OffsetNumber = ADC_OFFSET_NONE;
+	sConfig.Offset = 0;
+	rank = 0;
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(channels & (1 << k))
+		{
+			sConfig.Channel = AS_AdcChannel[k];
+			sConfig.Rank = ADC_REGULAR_RANK_1 + rank++;
+			sConfig.SamplingTime = AS_SamplingTime[k];
+			if(HAL_ADC_ConfigChannel(&hadc1, &sConfig) != HAL_OK)
+			{
+				return HAL_ERROR;
+			}
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * AS_Restore
+ * @brief
+ * Give ADC1 back its configuration of MX_ADC1_Init (single channel ADC1_IN1, software start).
+ * The internal paths opened by the scan (sensor, VREFINT, VBAT divider) are closed, the divider
+ * would drain the backup battery during the sleep.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef AS_Restore(void)
+{
+	ADC_ChannelConfTypeDef sConfig = {0};
+
+	hadc1.Init = AS_AdcInit;
+	if(HAL_ADC_Init(&hadc1) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	CLEAR_BIT(ADC12_COMMON->CCR, ADC_CCR_TSEN | ADC_CCR_VBATEN | ADC_CCR_VREFEN);
+
+	sConfig.Channel = ADC_CHANNEL_1;
+	sConfig.Rank = ADC_REGULAR_RANK_1;
+	sConfig.SingleDiff = ADC_SINGLE_ENDED;
+	sConfig.SamplingTime = ADC_SAMPLETIME_4CYCLES_5;
+	sConfig.OffsetNumber = ADC_OFFSET_NONE;
+	sConfig.Offset = 0;
+
+	return HAL_ADC_ConfigChannel(&hadc1, &sConfig);
+}
+
+/*
+ * AS_Deliver
+ * @brief
+ * Filter and tag a block of scans, then give it to the callback.
+ * TIM2 holds the capture of the last trigger. Its number is found from the previous block,
+ * then the time of the first scan of the block is deduced from the capture.
+ * @param
+ * samples : First sample of the block in the DMA buffer
+ * @return
+ * none
+ */
+void AS_Deliver(uint16_t * samples)
+{
+	AS_Block_t block;
+	uint32_t capture = HAL_TIM_ReadCapturedValue(&AS_htim2, TIM_CHANNEL_1);
+	uint32_t last = AS_RefIndex + (capture - AS_RefTime + AS_Period / 2) / AS_Period;
+	uint8_t position = 0;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(AS_Channels & (1 << k))
+		{
+			FLT_Process(AS_Filter[k], &samples[position++], AS_Scans, AS_Width);
+		}
+	}
+
+	block.timestamp = capture - (last - AS_Index) * AS_Period;
+	block.index = AS_Index;
+	block.period = AS_Period;
+	block.count = AS_Scans;
+	block.channels = AS_Channels;
+	block.width = AS_Width;
+	block.samples = samples;
+
+	AS_RefTime = block.timestamp;
+	AS_RefIndex = AS_Index;
+	AS_Index += AS_Scans;
+
+	AS_UserCallback(&block);
+}
@@ -0,0 +1,462 @@
+/*
+ * Alarm.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Alarm.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define ALM_EMPTY				0xFFFFFFFF	// Sequence of an erased slot
+
+typedef enum
+{
+	ALM_ARMED	= 0,	// The scans fill the pre-trigger ring, the thresholds are checked
+	ALM_CAPTURE	= 1,	// An alarm fired, the post-trigger scans are captured
+	ALM_COMPLETE	= 2,	// The event is in RAM, waiting for ALM_Process
+	ALM_HOLD	= 3		// The event is stored, the scans fill the ring until they are back inside the thresholds
+}ALM_State_t;
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+ALM_Threshold_t ALM_Threshold[AS_NB_CHANNELS];
+
+uint16_t ALM_Ring[ALM_SCANS * AS_NB_CHANNELS];	// Last scans of the stream
+uint16_t ALM_Size;						// Samples of the ring (ALM_SCANS whole scans)
+uint16_t ALM_Head;						// Next sample of the ring
+uint16_t ALM_Filled;					// Scans stored since the ring was armed
+uint16_t ALM_Remaining;					// Scans left to capture after the trigger
+
+uint16_t ALM_Previous[AS_NB_CHANNELS];	// Previous scan, for the rate of change
+uint16_t ALM_Last[AS_NB_CHANNELS];		// Newest scan, for the periodic log
+uint8_t ALM_Primed = 0;
+
+volatile ALM_State_t ALM_State = ALM_ARMED;
+ALM_Event_t ALM_Pending;				// Event being captured
+
+uint32_t ALM_Sequence;					// Number of the next event
+uint8_t ALM_Slot;						// Slot of the next event
+
+uint8_t ALM_Page[EE_SIZE_PAGE];			// Chunk buffer of the scans streamed by ALM_Export
+uint32_t ALM_CrcValue;					// CRC of the scans streamed by ALM_Export
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+ALM_Type_t ALM_Check(uint16_t * scan, uint8_t channels, uint8_t * channel, uint16_t * value);
+uint8_t ALM_isInside(uint16_t * scan, uint8_t channels);
+uint8_t ALM_CrcChunk(uint8_t * data, uint16_t length);
+
+
+/***************************************************************************************/
+/*
+ * ALM_Init
+ * @brief
+ * Initialize the alarms, all the thresholds are disabled.
+ * The headers of the event region are read to go on after the newest event.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef ALM_Init(void)
+{
+	ALM_Event_t event;
+	uint32_t newest = ALM_EMPTY;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		ALM_Threshold[k].high = ALM_HIGH_OFF;
+		ALM_Threshold[k].low = ALM_LOW_OFF;
+		ALM_Threshold[k].rate = ALM_RATE_OFF;
+	}
+
+	ALM_Sequence = 0;
+	ALM_Slot = 0;
+	for(uint8_t s = 0; s < ALM_NB_SLOTS; s++)
+	{
+		if(EE_Read(LOG_EVENT_START + s * ALM_SLOT_SIZE, (uint8_t *)&event, ALM_EVENT_SIZE) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+
+		if(event.sequence != ALM_EMPTY && (newest == ALM_EMPTY || event.sequence > newest))
+		{
+			newest = event.sequence;
+			ALM_Sequence = newest + 1;
+			ALM_Slot = (s + 1) % ALM_NB_SLOTS;
+		}
+	}
+
+	ALM_Filled = 0;
+	ALM_Size = 0;
+	ALM_Primed = 0;
+	ALM_State = ALM_ARMED;
+
+	return HAL_OK;
+}
+
+/*
+ * ALM_setThreshold
+ * @brief
+ * Set the alarm thresholds of a channel
+ * @param
+ * channel		:	One LOG_CHANNEL_xxx
+ * threshold	:	High, low and rate thresholds in raw counts
+ * @return
+ * none
+ */
+void ALM_setThreshold(uint8_t channel, ALM_Threshold_t threshold)
+{
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(channel & (1 << k))
+		{
+			ALM_Threshold[k] = threshold;
+			return;
+		}
+	}
+}
+
+/*
+ * ALM_Stream
+ * @brief
+ * Callback of the ADC stream (see AS_Start), called from the DMA interrupt.
+ * Every scan goes into the pre-trigger ring. When a threshold is crossed, the ring goes on
+ * for ALM_POST_SCANS scans then stays frozen until ALM_Process has stored the event.
+ * The alarms are armed again once a scan is back inside the thresholds by ALM_HYSTERESIS,
+ * so that a lasting excursion is stored once.
+ * @param
+ * block : Block of scans
+ * @return
+ * none
+ */
+void ALM_Stream(AS_Block_t * block)
+{
+	uint16_t * scan;
+	ALM_Type_t type;
+	uint8_t channel;
+	uint16_t value;
+
+	//A new channel list restarts the ring
+	if((ALM_State == ALM_ARMED || ALM_State == ALM_HOLD) && ALM_Size != ALM_SCANS * block->width)
+	{
+		ALM_Size = ALM_SCANS * block->width;
+		ALM_Head = 0;
+		ALM_Filled = 0;
+		ALM_Primed = 0;
+	}
+
+	for(uint16_t i = 0; i < block->count; i++)
+	{
+		scan = &block->samples[i * block->width];
+
+		if(ALM_State != ALM_COMPLETE)
+		{
+			memcpy(&ALM_Ring[ALM_Head], scan, block->width * sizeof(uint16_t));
+			ALM_Head = (ALM_Head + block->width) % ALM_Size;
+			if(ALM_Filled < ALM_SCANS)
+			{
+				ALM_Filled++;
+			}
+		}
+
+		if(ALM_State == ALM_HOLD && ALM_isInside(scan, block->channels))
+		{
+			ALM_State = ALM_ARMED;
+		}
+		else if(ALM_State == ALM_ARMED)
+		{
+			type = ALM_Check(scan, block->channels, &channel, &value);
+			if(type != ALM_NONE)
+			{
+				ALM_Pending.time = block->timestamp + i * block->period;
+				ALM_Pending.period = block->period;
+				ALM_Pending.pre = (ALM_Filled - 1 < ALM_PRE_SCANS) ? ALM_Filled - 1 : ALM_PRE_SCANS;
+				ALM_Pending.post = ALM_POST_SCANS;
+				ALM_Pending.channels = block->channels;
+				ALM_Pending.width = block->width;
+				ALM_Pending.channel = channel;
+				ALM_Pending.type = type;
+				ALM_Pending.value = value;
+				ALM_Remaining = ALM_POST_SCANS;
+				ALM_State = ALM_CAPTURE;
+			}
+		}
+
+		if(ALM_State == ALM_CAPTURE && --ALM_Remaining == 0)
+		{
+			ALM_State = ALM_COMPLETE;
+		}
+
+		memcpy(ALM_Previous, scan, block->width * sizeof(uint16_t));
+		memcpy(ALM_Last, scan, block->width * sizeof(uint16_t));
+		ALM_Primed = 1;
+	}
+}
+
+/*
+ * ALM_Process
+ * @brief
+ * Store the captured event in the next slot of the event region and mark it in the sample log,
+ * then wait for the scans to come back inside the thresholds. Nothing to do while no event is complete.
+ * Called from the main loop, the EEPROM is not written from the interrupt.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef ALM_Process(void)
+{
+	ALM_Event_t event;
+	uint16_t length, first, split;
+	EE_Vector_t vector[3];
+	HAL_StatusTypeDef state;
+
+	if(ALM_State != ALM_COMPLETE)
+	{
+		return HAL_OK;
+	}
+
+	event = ALM_Pending;
+	event.sequence = ALM_Sequence;
+	event.timestamp = IRTC_getTimestamp() - (AS_getTime() - event.time) / AS_TIMEBASE;
+	event.reserved = 0xFFFF;
+
+	//The event is made of the newest scans of the ring, which may wrap
+	length = (event.pre + event.post) * event.width;
+	first = (ALM_Head + ALM_Size - length) % ALM_Size;
+	split = (first + length > ALM_Size) ? ALM_Size - first : length;
+
+	event.crc = CRC32_Compute((uint8_t *)&event, offsetof(ALM_Event_t, crc));
+	event.crc = CRC32_Accumulate(event.crc, (uint8_t *)&ALM_Ring[first], split * sizeof(uint16_t));
+	event.crc = CRC32_Accumulate(event.crc, (uint8_t *)ALM_Ring, (length - split) * sizeof(uint16_t));
+
+	//Header and both parts of the ring written straight from RAM, the ring is frozen until the event is stored
+	vector[0].data = (uint8_t *)&event;
+	vector[0].length = ALM_EVENT_SIZE;
+	vector[1].data = (uint8_t *)&ALM_Ring[first];
+	vector[1].length = split * sizeof(uint16_t);
+	vector[2].data = (uint8_t *)ALM_Ring;
+	vector[2].length = (length - split) * sizeof(uint16_t);
+	state = EE_Writev(LOG_EVENT_START + ALM_Slot * ALM_SLOT_SIZE, vector, 3);
+
+	if(state == HAL_OK)
+	{
+		STO_Count(&STO_Eeprom, LOG_EVENT_START + ALM_Slot * ALM_SLOT_SIZE, ALM_EVENT_SIZE + length * sizeof(uint16_t));
+		state = LOG_Event(event.timestamp, event.channel, event.sequence);
+	}
+
+	ALM_Sequence++;
+	ALM_Slot = (ALM_Slot + 1) % ALM_NB_SLOTS;
+
+	//The ring starts again from an empty pre-trigger window, armed by ALM_Stream
+	ALM_Filled = 0;
+	ALM_State = ALM_HOLD;
+
+	return state;
+}
+
+/*
+ * ALM_getScan
+ * @brief
+ * Get the newest scan of the stream
+ * @param
+ * values : Raw conversions, one per channel of the stream in the order of the bits
+ * @return
+ * HAL_StatusTypeDef : Status of the stream
+ * 					- HAL_OK
+ * 					- HAL_BUSY		no scan received yet
+ */
+HAL_StatusTypeDef ALM_getScan(uint16_t * values)
+{
+	if(!ALM_Primed)
+	{
+		return HAL_BUSY;
+	}
+
+	__disable_irq();
+	memcpy(values, ALM_Last, sizeof(ALM_Last));
+	__enable_irq();
+
+	return HAL_OK;
+}
+
+/*
+ * ALM_Export
+ * @brief
+ * Read the headers of the stored events, from the oldest to the newest.
+ * The events with a wrong CRC are not given to the callback.
+ * @param
+ * callback : Function called with the header of each event and the address of its first scan
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef ALM_Export(ALM_Callback_t callback)
+{
+	ALM_Event_t event;
+	uint32_t addr, length;
+
+	for(uint8_t k = 0; k < ALM_NB_SLOTS; k++)
+	{
+		addr = LOG_EVENT_START + ((ALM_Slot + k) % ALM_NB_SLOTS) * ALM_SLOT_SIZE;
+		if(EE_Read(addr, (uint8_t *)&event, ALM_EVENT_SIZE) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+		if(event.sequence == ALM_EMPTY || event.width > AS_NB_CHANNELS || event.pre + event.post > ALM_SCANS)
+		{
+			continue;
+		}
+
+		//Scans streamed in a single read
+		ALM_CrcValue = CRC32_Compute((uint8_t *)&event, offsetof(ALM_Event_t, crc));
+		length = (event.pre + event.post) * event.width * sizeof(uint16_t);
+		if(EE_Stream(addr + ALM_EVENT_SIZE, length, ALM_Page, sizeof(ALM_Page), ALM_CrcChunk) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+
+		if(ALM_CrcValue == event.crc)
+		{
+			callback(&event, addr + ALM_EVENT_SIZE);
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * ALM_Check
+ * @brief
+ * Compare a scan to the thresholds of its channels
+ * @param
+ * scan		:	Samples of the scan
+ * channels	:	Bitmap of the channels of the scan
+ * channel	:	Channel that fired the alarm
+ * value	:	Sample that fired the alarm
+ * @return
+ * ALM_Type_t : First threshold crossed, ALM_NONE if none
+ */
+ALM_Type_t ALM_Check(uint16_t * scan, uint8_t channels, uint8_t * channel, uint16_t * value)
+{
+	ALM_Threshold_t * threshold;
+	uint8_t position = 0;
+	int32_t delta;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(!(channels & (1 << k)))
+		{
+			continue;
+		}
+
+		threshold = &ALM_Threshold[k];
+		*channel = 1 << k;
+		*value = scan[position];
+
+		if(scan[position] > threshold->high)
+		{
+			return ALM_HIGH;
+		}
+		if(scan[position] < threshold->low)
+		{
+			return ALM_LOW;
+		}
+
+		delta = (int32_t)scan[position] - ALM_Previous[position];
+		if(delta < 0)
+		{
+			delta = -delta;
+		}
+		if(ALM_Primed && threshold->rate != ALM_RATE_OFF && delta > threshold->rate)
+		{
+			return ALM_RATE;
+		}
+
+		position++;
+	}
+
+	return ALM_NONE;
+}
+
+/*
+ * ALM_isInside
+ * @brief
+ * Check that a scan is back inside the thresholds of its channels, by ALM_HYSTERESIS for the
+ * high and low ones. The thresholds disabled are not checked.
+ * @param
+ * scan		:	Samples of the scan
+ * channels	:	Bitmap of the channels of the scan
+ * @return
+ * uint8_t : 1 if the alarms can be armed again
+ */
+uint8_t ALM_isInside(uint16_t * scan, uint8_t channels)
+{
+	ALM_Threshold_t * threshold;
+	uint8_t position = 0;
+	int32_t delta;
+
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(!(channels & (1 << k)))
+		{
+			continue;
+		}
+
+		threshold = &ALM_Threshold[k];
+		if(threshold->high != ALM_HIGH_OFF && (int32_t)scan[position] > (int32_t)threshold->high - ALM_HYSTERESIS)
+		{
+			return 0;
+		}
+		if(threshold->low != ALM_LOW_OFF && (int32_t)scan[position] < (int32_t)threshold->low + ALM_HYSTERESIS)
+		{
+			return 0;
+		}
+
+		delta = (int32_t)scan[position] - ALM_Previous[position];
+		if(delta < 0)
+		{
+			delta = -delta;
+		}
+		if(threshold->rate != ALM_RATE_OFF && delta > threshold->rate)
+		{
+			return 0;
+		}
+
+		position++;
+	}
+
+	return 1;
+}
+
+/*
+ * ALM_CrcChunk
+ * @brief
+ * Add a chunk of scans streamed by ALM_Export to the CRC of the event
+ * @param
+ * data		:	Scans read
+ * length	:	Number of Bytes
+ * @return
+ * uint8_t : 1, the whole event is read
+ */
+uint8_t ALM_CrcChunk(uint8_t * data, uint16_t length)
+{
+	ALM_CrcValue = CRC32_Accumulate(ALM_CrcValue, data, length);
+
+	return 1;
+}
@@ -0,0 +1,389 @@
+/*
+ * Burst.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Burst.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define BST_PAGE_SAMPLES		(EE_SIZE_PAGE / sizeof(uint16_t))
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+volatile uint8_t BST_Requested = 0;		// B1 was pressed
+uint32_t BST_LastPress = 0;				// Tick of the last press of B1
+
+uint16_t BST_Fifo[BST_FIFO_PAGES][BST_PAGE_SAMPLES];	// Pages filled by the DMA interrupt
+volatile uint8_t BST_Head;				// Page being filled
+volatile uint8_t BST_Tail;				// Next page to write in the EEPROM
+uint16_t BST_Offset;					// Next sample of the page being filled
+
+BST_Header_t BST_Header;
+uint32_t BST_Total;						// Scans of the burst
+uint32_t BST_Samples;					// Samples received
+volatile uint8_t BST_Done;				// The last scan was received
+uint32_t BST_CrcValue;					// CRC of the scans sent by BST_Run, or streamed by BST_Crc
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void BST_Stream(AS_Block_t * block);
+HAL_StatusTypeDef BST_Send(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef BST_Crc(BST_Header_t * header, uint32_t * crc);
+uint8_t BST_CrcChunk(uint8_t * data, uint16_t length);
+
+
+/***************************************************************************************/
+/*
+ * BST_Init
+ * @brief
+ * Enable the interrupt of B1 (EXTI line 13, configured on the falling edge by MX_GPIO_Init)
+ * @param
+ * none
+ * @return
+ * none
+ */
+void BST_Init(void)
+{
+	BST_Requested = 0;
+
+	HAL_NVIC_SetPriority(EXTI15_10_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(EXTI15_10_IRQn);
+}
+
+/*
+ * BST_isRequested
+ * @brief
+ * Check if a burst was requested by B1
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 if B1 was pressed since the last burst
+ */
+uint8_t BST_isRequested(void)
+{
+	return BST_Requested;
+}
+
+/*
+ * BST_Run
+ * @brief
+ * Capture a burst of BST_DURATION ms at BST_RATE into the burst region of the EEPROM, then return.
+ * The scans go to the least worn part of the region, only the header page stays in place.
+ * The DMA interrupt fills a FIFO of pages which are written here as soon as they are full,
+ * the header is written last with the number of scans actually stored.
+ * The CRC is computed on the pages in RAM as they are sent, then checked against the scans read back :
+ * a burst badly written is not validated by its header.
+ * The ADC stream must be stopped, it is stopped again at the end of the burst.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the capture
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_ERROR		also when the scans read back do not match the CRC
+ * 					- HAL_BUSY
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef BST_Run(void)
+{
+	HAL_StatusTypeDef state;
+	uint32_t addr, crc;
+	uint32_t tickstart;
+
+	BST_Header.timestamp = IRTC_getTimestamp();
+	BST_Header.count = 0;
+	BST_Header.channels = BST_CHANNELS;
+	BST_Header.width = 0;
+	BST_Header.flags = 0;
+	BST_Header.reserved = 0xFF;
+	for(uint8_t k = 0; k < AS_NB_CHANNELS; k++)
+	{
+		if(BST_CHANNELS & (1 << k))
+		{
+			BST_Header.width++;
+		}
+	}
+
+	BST_Total = (uint64_t)BST_RATE * BST_DURATION / 1000;
+	if(BST_Total > BST_DATA_SIZE / sizeof(uint16_t) / BST_Header.width)
+	{
+		BST_Total = BST_DATA_SIZE / sizeof(uint16_t) / BST_Header.width;
+	}
+	BST_Header.start = WEAR_Allocate(BST_DATA_START, BST_DATA_SIZE, BST_Total * BST_Header.width * sizeof(uint16_t));
+	addr = BST_Header.start;
+	BST_Head = 0;
+	BST_Tail = 0;
+	BST_Offset = 0;
+	BST_Samples = 0;
+	BST_Done = 0;
+	BST_CrcValue = CRC32_INIT;
+
+	state = AS_Start(BST_RATE, BST_CHANNELS, BST_Stream);
+	if(state != HAL_OK)
+	{
+		BST_Requested = 0;
+		return state;
+	}
+
+	tickstart = HAL_GetTick();
+	while(state == HAL_OK)
+	{
+		if(BST_Tail != BST_Head)
+		{
+			state = BST_Send(addr, (uint8_t *)BST_Fifo[BST_Tail], EE_SIZE_PAGE);
+			addr += EE_SIZE_PAGE;
+			BST_Tail = (BST_Tail + 1) % BST_FIFO_PAGES;
+		}
+		else if(BST_Done)
+		{
+			break;
+		}
+		else if(HAL_GetTick() - tickstart > BST_DURATION + BST_TIMEOUT)
+		{
+			state = HAL_TIMEOUT;
+		}
+	}
+	AS_Stop();
+
+	//Last page, partly filled
+	if(state == HAL_OK && BST_Offset)
+	{
+		state = BST_Send(addr, (uint8_t *)BST_Fifo[BST_Head], BST_Offset * sizeof(uint16_t));
+	}
+
+	//CRC of the scans sent, checked on the scans read back
+	BST_Header.crc = CRC32_Accumulate(BST_CrcValue, (uint8_t *)&BST_Header, offsetof(BST_Header_t, crc));
+	if(state == HAL_OK)
+	{
+		state = BST_Crc(&BST_Header, &crc);
+	}
+	if(state == HAL_OK && crc != BST_Header.crc)
+	{
+		state = HAL_ERROR;
+	}
+	if(state == HAL_OK)
+	{
+		state = STO_Program(&STO_Eeprom, LOG_BURST_START, (uint8_t *)&BST_Header, BST_HEADER_SIZE);
+	}
+
+	BST_Requested = 0;
+
+	return state;
+}
+
+/*
+ * BST_getHeader
+ * @brief
+ * Read the header of the last burst and check the CRC of its scans
+ * @param
+ * header : Header of the burst, the scans start at header->start
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no valid burst
+ */
+HAL_StatusTypeDef BST_getHeader(BST_Header_t * header)
+{
+	uint32_t crc;
+
+	if(EE_Read(LOG_BURST_START, (uint8_t *)header, BST_HEADER_SIZE) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	if(header->width == 0 || header->width > AS_NB_CHANNELS || header->start < BST_DATA_START || header->start >= BST_DATA_START + BST_DATA_SIZE)
+	{
+		return HAL_ERROR;
+	}
+	if(header->count > (BST_DATA_START + BST_DATA_SIZE - header->start) / sizeof(uint16_t) / header->width)
+	{
+		return HAL_ERROR;
+	}
+
+	if(BST_Crc(header, &crc) != HAL_OK || crc != header->crc)
+	{
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * BST_IRQHandler
+ * @brief
+ * Handle the interrupt of B1, called by EXTI15_10_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void BST_IRQHandler(void)
+{
+	HAL_GPIO_EXTI_IRQHandler(B1_Pin);
+}
+
+/*
+ * HAL_GPIO_EXTI_Callback
+ * @brief
+ * Press of B1, the bounces are filtered by BST_DEBOUNCE
+ * @param
+ * GPIO_Pin : Pin of the EXTI line
+ * @return
+ * none
+ */
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin)
+{
+	if(GPIO_Pin != B1_Pin)
+	{
+		return;
+	}
+
+	if(HAL_GetTick() - BST_LastPress > BST_DEBOUNCE)
+	{
+		BST_Requested = 1;
+	}
+	BST_LastPress = HAL_GetTick();
+}
+
+/*
+ * BST_Stream
+ * @brief
+ * Callback of the ADC stream during a burst, called from the DMA interrupt.
+ * The scans are copied into the FIFO of pages. If the EEPROM writes fall behind,
+ * the burst ends there so that the stored scans stay contiguous.
+ * @param
+ * block : Block of scans
+ * @return
+ * none
+ */
+void BST_Stream(AS_Block_t * block)
+{
+	uint32_t samples;
+	uint8_t next;
+
+	if(BST_Done)
+	{
+		return;
+	}
+
+	if(BST_Samples == 0)
+	{
+		BST_Header.time = block->timestamp;
+		BST_Header.period = block->period;
+	}
+
+	samples = block->count * block->width;
+	if(samples > BST_Total * block->width - BST_Samples)
+	{
+		samples = BST_Total * block->width - BST_Samples;
+	}
+
+	for(uint32_t i = 0; i < samples; i++)
+	{
+		BST_Fifo[BST_Head][BST_Offset++] = block->samples[i];
+		BST_Samples++;
+
+		if(BST_Offset == BST_PAGE_SAMPLES)
+		{
+			next = (BST_Head + 1) % BST_FIFO_PAGES;
+			if(next == BST_Tail)
+			{
+				//The page just filled is dropped, the burst ends with the last page written
+				BST_Header.count = (BST_Samples - BST_PAGE_SAMPLES) / block->width;
+				BST_Header.flags |= BST_FLAG_OVERRUN;
+				BST_Offset = 0;
+				BST_Done = 1;
+				return;
+			}
+			BST_Head = next;
+			BST_Offset = 0;
+		}
+	}
+
+	BST_Header.count = BST_Samples / block->width;
+	if(BST_Header.count == BST_Total)
+	{
+		BST_Done = 1;
+	}
+}
+
+/*
+ * BST_Send
+ * @brief
+ * Add a page of scans to the CRC of the burst, then write it in the EEPROM
+ * @param
+ * addr		:	Address of the page in the EEPROM
+ * data		:	Scans of the FIFO
+ * length	:	Number of Bytes
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef BST_Send(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	BST_CrcValue = CRC32_Accumulate(BST_CrcValue, data, length);
+
+	return STO_Program(&STO_Eeprom, addr, data, length);
+}
+
+/*
+ * BST_Crc
+ * @brief
+ * Compute the CRC of a burst from the EEPROM : the scans then the header. The scans of a burst cut
+ * short fill whole pages, the partial scan at the end of the last page is covered too.
+ * The scans are streamed with the FIFO as chunk buffer, it is free outside of a burst.
+ * @param
+ * header	:	Header of the burst
+ * crc		:	CRC-32 of the burst
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef BST_Crc(BST_Header_t * header, uint32_t * crc)
+{
+	uint32_t length = header->count * header->width * sizeof(uint16_t);
+
+	if(header->flags & BST_FLAG_OVERRUN)
+	{
+		length = (length + EE_SIZE_PAGE - 1) / EE_SIZE_PAGE * EE_SIZE_PAGE;
+	}
+
+	BST_CrcValue = CRC32_INIT;
+	if(EE_Stream(header->start, length, (uint8_t *)BST_Fifo, sizeof(BST_Fifo), BST_CrcChunk) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	*crc = CRC32_Accumulate(BST_CrcValue, (uint8_t *)header, offsetof(BST_Header_t, crc));
+
+	return HAL_OK;
+}
+
+/*
+ * BST_CrcChunk
+ * @brief
+ * Add a chunk of scans streamed by BST_Crc to the CRC
+ * @param
+ * data		:	Scans read
+ * length	:	Number of Bytes
+ * @return
+ * uint8_t : 1, the whole burst is read
+ */
+uint8_t BST_CrcChunk(uint8_t * data, uint16_t length)
+{
+	BST_CrcValue = CRC32_Accumulate(BST_CrcValue, data, length);
+
+	return 1;
+}
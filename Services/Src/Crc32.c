@@ -0,0 +1,146 @@
+/*
+ * Crc32.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Crc32.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+
+
+/***************************************************************************************/
+/*
+ * CRC32_Compute
+ * @brief
+ * Compute the CRC of a buffer
+ * @param
+ * data		:	Buffer of data
+ * length	:	Number of Bytes of the buffer
+ * @return
+ * uint32_t : CRC of the buffer
+ */
+uint32_t CRC32_Compute(uint8_t * data, uint16_t length)
+{
+	return CRC32_Accumulate(CRC32_INIT, data, length);
+}
+
+#ifndef STO_HOST
+/*
+ * CRC32_Init
+ * @brief
+ * Initialize the CRC calculation unit of the MCU
+ * - 32 bits polynomial 0x04C11DB7
+ * - No reversal of the input and output data, no final XOR (CRC-32/MPEG-2)
+ *
+ * The registers are accessed directly, the CRC HAL driver is not part of the project
+ * @param
+ * none
+ * @return
+ * none
+ */
+void CRC32_Init(void)
+{
+	__HAL_RCC_CRC_CLK_ENABLE();
+
+	CRC->CR = 0;
+	CRC->POL = CRC32_POLYNOMIAL;
+	CRC->INIT = CRC32_INIT;
+	CRC->CR = CRC_CR_RESET;
+}
+
+/*
+ * CRC32_Accumulate
+ * @brief
+ * Go on with the computation of a CRC over a new buffer
+ * The CRC unit restarts from the given value, so several CRC can be computed in parallel.
+ * The data are written 32 bits at a time, Byte swapped to keep the order of the Bytes in memory,
+ * and the last Bytes are written one by one.
+ *
+ * This function must not be called from an interrupt
+ * @param
+ * crc		:	CRC of the previous data (CRC32_INIT to start a new computation)
+ * data		:	Buffer of data
+ * length	:	Number of Bytes of the buffer
+ * @return
+ * uint32_t : CRC of the previous data followed by the buffer
+ */
+uint32_t CRC32_Accumulate(uint32_t crc, uint8_t * data, uint16_t length)
+{
+	uint32_t word;
+
+	CRC->INIT = crc;
+	CRC->CR |= CRC_CR_RESET;
+
+	while(length >= sizeof(uint32_t))
+	{
+		memcpy(&word, data, sizeof(uint32_t));
+		CRC->DR = __REV(word);
+
+		data += sizeof(uint32_t);
+		length -= sizeof(uint32_t);
+	}
+
+	while(length--)
+	{
+		*(__IO uint8_t *)&CRC->DR = *data++;
+	}
+
+	return CRC->DR;
+}
+
+#else
+/*
+ * CRC32_Init
+ * @brief
+ * Nothing to initialize on the host, the CRC is computed by software (see CRC32_Accumulate)
+ * @param
+ * none
+ * @return
+ * none
+ */
+void CRC32_Init(void)
+{
+}
+
+/*
+ * CRC32_Accumulate
+ * @brief
+ * Software CRC of the builds on a Linux host (-DSTO_HOST), bit by bit :
+ * same polynomial, Byte order and result as the CRC unit of the MCU
+ * @param
+ * crc		:	CRC of the previous data (CRC32_INIT to start a new computation)
+ * data		:	Buffer of data
+ * length	:	Number of Bytes of the buffer
+ * @return
+ * uint32_t : CRC of the previous data followed by the buffer
+ */
+uint32_t CRC32_Accumulate(uint32_t crc, uint8_t * data, uint16_t length)
+{
+	while(length--)
+	{
+		crc ^= (uint32_t)*data++ << 24;
+		for(uint8_t bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x80000000) ? (crc << 1) ^ CRC32_POLYNOMIAL : crc << 1;
+		}
+	}
+
+	return crc;
+}
+#endif
@@ -0,0 +1,977 @@
+/*
+ * DataLog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "DataLog.h"
+#include "LogIndex.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+LOG_Config_t LOG_Config = {LOG_MODE_DEADBAND, LOG_DEFAULT_DEADBAND, LOG_DEFAULT_HEARTBEAT};
+
+uint32_t LOG_RawIndex[IDX_PAGES(LOG_RAW_SIZE) * LOG_RAW_CHIPS];	// Room for a log striped over LOG_RAW_CHIPS chips
+uint8_t LOG_RawPage[EE_SIZE_PAGE];
+LOG_Ring_t LOG_RawRing = {LOG_RAW_START, LOG_RAW_SIZE, LOG_RAW_START, 0, LOG_RawIndex, LOG_RawPage, NULL};
+
+LOG_Record_t LOG_LastRecord[LOG_NB_CHANNELS];		// Last record stored in the sample log for each channel
+uint8_t LOG_HasLastRecord = 0;						// Bitmap of the channels stored since the reset
+
+uint32_t LOG_PageBuffer[LOG_SCAN_PAGES * EE_SIZE_PAGE / sizeof(uint32_t)];	// Chunks of pages streamed by LOG_RingScan
+LOG_Scan_t LOG_Scan;				// Scan in progress
+uint32_t LOG_CrcErrors = 0;			// Number of pages read with a wrong CRC
+uint32_t LOG_TierErrors = 0;		// Number of pages overwritten before their records reached the overflow tier
+
+LOG_Callback_t LOG_UserCallback;
+uint32_t LOG_TierT0, LOG_TierT1;	// Time range of the records of the overflow tier given to the callback
+FLOG_Log_t * LOG_Mirror = NULL;		// Log of a flash which receives a copy of the records
+FLOG_Log_t * LOG_Overflow = NULL;	// Log which receives the records of the pages overwritten
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void LOG_RecordVisitor(uint8_t * record);
+void LOG_TierVisitor(uint8_t * record);
+HAL_StatusTypeDef LOG_TierScan(uint32_t t0, uint32_t t1);
+uint8_t LOG_isPageValid(uint8_t * page);
+HAL_StatusTypeDef LOG_RingSeal(LOG_Ring_t * ring, uint32_t addr);
+uint8_t LOG_ScanChunk(uint8_t * data, uint16_t length);
+uint8_t LOG_ChannelIndex(uint8_t channel);
+HAL_StatusTypeDef LOG_Evict(void);
+uint32_t LOG_RingOrdinal(LOG_Ring_t * ring, uint32_t addr, uint16_t length);
+
+
+/***************************************************************************************/
+/*
+ * LOG_Init
+ * @brief
+ * Initialize the sample log
+ * The index of the log is rebuilt from the device and the log goes on after its newest record.
+ * The next sample of each channel is always stored.
+ * On a stripe of EEPROMs, the log takes LOG_RAW_SIZE per chip for LOG_RAW_CHIPS chips at most,
+ * spread over all the chips (see EepromArray.h). Without device (stripe changed), nothing is logged.
+ * @param
+ * config	:	Logging mode, dead-band and heartbeat
+ * device	:	Storage device of the log (STO_Eeprom, or EEA_getDevice), NULL to log nothing
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Init(LOG_Config_t config, const STO_Device_t * device)
+{
+	uint32_t chips = 1;
+
+	LOG_SetConfig(config);
+
+	LOG_HasLastRecord = 0;
+	LOG_RawRing.device = device;
+
+	if(device != NULL && device->size / EE_SIZE_MEMORY > 1)
+	{
+		chips = device->size / EE_SIZE_MEMORY;
+	}
+	if(chips > LOG_RAW_CHIPS)
+	{
+		chips = LOG_RAW_CHIPS;
+	}
+	LOG_RawRing.size = LOG_RAW_SIZE * chips;
+
+	return LOG_RingInit(&LOG_RawRing, LOG_RECORD_SIZE);
+}
+
+/*
+ * LOG_SetConfig
+ * @brief
+ * Change the logging mode, the dead-band or the heartbeat interval
+ * @param
+ * config : Logging mode, dead-band and heartbeat
+ * @return
+ * none
+ */
+void LOG_SetConfig(LOG_Config_t config)
+{
+	LOG_Config = config;
+}
+
+/*
+ * LOG_Process
+ * @brief
+ * Give a new sample of a channel to the log.
+ * In dead-band mode, the sample is stored only if :
+ * - it is the first sample of the channel since the reset
+ * - it differs from the last stored value of the channel by more than the dead-band
+ * - the heartbeat interval elapsed since the last stored record of the channel
+ * Every record carries its own timestamp so the time of each stored sample stays exact on export.
+ * Between two records, the value is known to stay within the dead-band of the first one.
+ * @param
+ * timestamp	:	Time of the sample in seconds since 01/01/2000 00:00:00
+ * channel		:	Channel of the sample (one LOG_CHANNEL_xxx)
+ * value		:	Value of the sample
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Process(uint32_t timestamp, uint8_t channel, int16_t value)
+{
+	LOG_Record_t record;
+	LOG_Record_t * last = &LOG_LastRecord[LOG_ChannelIndex(channel)];
+	int32_t delta;
+
+	record.timestamp = timestamp;
+	record.value = value;
+	record.channel = channel;
+	record.flags = 0;
+
+	if(!(LOG_HasLastRecord & channel))
+	{
+		record.flags = LOG_FLAG_FIRST;
+	}
+	else if(LOG_Config.mode == LOG_MODE_DEADBAND)
+	{
+		delta = (int32_t)value - last->value;
+		if(delta < 0)
+		{
+			delta = -delta;
+		}
+
+		if(delta > LOG_Config.deadBand)
+		{
+			record.flags = LOG_FLAG_CHANGE;
+		}
+		else if(timestamp - last->timestamp >= LOG_Config.heartbeat)
+		{
+			record.flags = LOG_FLAG_HEARTBEAT;
+		}
+		else
+		{
+			//Sample inside the dead-band, nothing to store
+			return HAL_OK;
+		}
+	}
+
+	return LOG_Append(&record);
+}
+
+/*
+ * LOG_Append
+ * @brief
+ * Store a record at the head of the sample log
+ * @param
+ * record : Record to be stored
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Append(LOG_Record_t * record)
+{
+	HAL_StatusTypeDef state;
+
+	state = LOG_RingAlign(&LOG_RawRing, (uint8_t *)record);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	//The records of the oldest page go to the overflow tier first. If the tier fails, they are lost
+	//but the sample log goes on.
+	if(LOG_Evict() != HAL_OK)
+	{
+		LOG_TierErrors++;
+	}
+
+	state = LOG_RingWrite(&LOG_RawRing, (uint8_t *)record, LOG_RECORD_SIZE);
+	if(LOG_Mirror != NULL)
+	{
+		FLOG_Append(LOG_Mirror, (uint8_t *)record);
+	}
+
+	//A record not stored is not the reference of the dead-band : the next sample is tried again
+	if(state == HAL_OK)
+	{
+		LOG_LastRecord[LOG_ChannelIndex(record->channel)] = *record;
+		LOG_HasLastRecord |= record->channel;
+	}
+
+	return state;
+}
+
+/*
+ * LOG_Event
+ * @brief
+ * Mark an alarm event in the sample log.
+ * The dead-band of the channel is not changed, its next sample is compared to the last stored value.
+ * @param
+ * timestamp	:	Time of the event in seconds since 01/01/2000 00:00:00
+ * channel		:	Channel that fired the alarm (one LOG_CHANNEL_xxx)
+ * number		:	Number of the event in the event region
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Event(uint32_t timestamp, uint8_t channel, uint16_t number)
+{
+	HAL_StatusTypeDef state;
+	LOG_Record_t record;
+
+	record.timestamp = timestamp;
+	record.value = number;
+	record.channel = channel;
+	record.flags = LOG_FLAG_EVENT;
+
+	state = LOG_RingAlign(&LOG_RawRing, (uint8_t *)&record);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	if(LOG_Evict() != HAL_OK)
+	{
+		LOG_TierErrors++;
+	}
+
+	if(LOG_Mirror != NULL)
+	{
+		FLOG_Append(LOG_Mirror, (uint8_t *)&record);
+	}
+
+	return LOG_RingWrite(&LOG_RawRing, (uint8_t *)&record, LOG_RECORD_SIZE);
+}
+
+/*
+ * LOG_Export
+ * @brief
+ * Read the whole sample log, from the oldest record to the newest one : the records moved
+ * into the overflow tier first, then the ones of the EEPROM.
+ * The records of a page with a wrong CRC are not given to the callback.
+ * @param
+ * callback : Function called for each record
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Export(LOG_Callback_t callback)
+{
+	HAL_StatusTypeDef state;
+
+	LOG_UserCallback = callback;
+
+	state = LOG_TierScan(0, IDX_EMPTY - 1);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	return LOG_RingScan(&LOG_RawRing, LOG_RECORD_SIZE, LOG_RingOldest(&LOG_RawRing), 0, IDX_EMPTY - 1, LOG_RecordVisitor);
+}
+
+/*
+ * LOG_Query
+ * @brief
+ * Read the records of the sample log between two dates.
+ * The overflow tier is read first, unless t0 is after the oldest page of the EEPROM.
+ * In the EEPROM, the first page is found with a binary search of the index in RAM,
+ * then only the pages from this one up to the last record before t1 are read.
+ * After a step back of the clock, the whole log is read.
+ * The records of a page with a wrong CRC are not given to the callback.
+ * @param
+ * t0		:	Start of the time range in seconds since 01/01/2000 00:00:00
+ * t1		:	End of the time range in seconds since 01/01/2000 00:00:00 (included)
+ * callback	:	Function called for each record of the time range
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_Query(uint32_t t0, uint32_t t1, LOG_Callback_t callback)
+{
+	HAL_StatusTypeDef state;
+	uint32_t pages = LOG_RawRing.size / EE_SIZE_PAGE;
+	uint32_t page = 0;
+
+	LOG_UserCallback = callback;
+
+	//Page after the one of the head : the oldest full page of the EEPROM
+	if(LOG_RawRing.wrapped)
+	{
+		page = ((LOG_RawRing.head - LOG_RawRing.start) / EE_SIZE_PAGE + 1) % pages;
+	}
+
+	//The tier only holds records older than the ones of the EEPROM, unless the clock went back
+	if(t0 <= LOG_RawRing.index[page] || !IDX_isOrdered(&LOG_RawRing))
+	{
+		state = LOG_TierScan(t0, t1);
+		if(state != HAL_OK)
+		{
+			return state;
+		}
+	}
+
+	return LOG_RingScan(&LOG_RawRing, LOG_RECORD_SIZE, IDX_Find(&LOG_RawRing, t0), t0, t1, LOG_RecordVisitor);
+}
+
+/*
+ * LOG_getCrcErrors
+ * @brief
+ * Get the number of pages read with a wrong CRC since the reset
+ * @param
+ * none
+ * @return
+ * uint32_t : Number of corrupted pages found
+ */
+uint32_t LOG_getCrcErrors(void)
+{
+	return LOG_CrcErrors;
+}
+
+/*
+ * LOG_getTierErrors
+ * @brief
+ * Get the number of pages of the sample log overwritten since the reset while their records
+ * could not be moved into the overflow tier
+ * @param
+ * none
+ * @return
+ * uint32_t : Number of pages lost
+ */
+uint32_t LOG_getTierErrors(void)
+{
+	return LOG_TierErrors;
+}
+
+/*
+ * LOG_setMirror
+ * @brief
+ * Copy the records of the sample log into a log of a flash, which keeps a much longer history.
+ * The records are only queued here, they are programmed by FLOG_Process.
+ * @param
+ * log : Log of the flash, NULL to stop the copy
+ * @return
+ * none
+ */
+void LOG_setMirror(FLOG_Log_t * log)
+{
+	LOG_Mirror = log;
+}
+
+/*
+ * LOG_setOverflow
+ * @brief
+ * Move the records of the oldest page of the sample log into a second tier (internal flash)
+ * before the page is overwritten, instead of losing them.
+ * @param
+ * log : Log of the second tier, NULL to let the oldest records be overwritten
+ * @return
+ * none
+ */
+void LOG_setOverflow(FLOG_Log_t * log)
+{
+	LOG_Overflow = log;
+}
+
+/*
+ * LOG_RingInit
+ * @brief
+ * Find the head of a circular area and load its page in RAM.
+ * If the page of the head has a wrong CRC (first write of the page interrupted by a reset), it is
+ * left as it is and the area goes on at the next page. If the head is at the start of a page,
+ * the previous page is the last one sealed : its CRC is written again if the seal was interrupted.
+ * The area must fit in its device. The page of the head is written again with each record,
+ * so a device which needs an erase before a program cannot hold a circular area.
+ * @param
+ * ring		:	Circular area
+ * length	:	Size of one record
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_RingInit(LOG_Ring_t * ring, uint16_t length)
+{
+	HAL_StatusTypeDef state;
+	uint32_t offset, previous, crc;
+
+	if(ring->device == NULL || ring->device->sector != STO_NO_ERASE || ring->size % EE_SIZE_PAGE
+		|| ring->start >= ring->device->size || ring->size > ring->device->size - ring->start)
+	{
+		return HAL_ERROR;
+	}
+
+	state = IDX_Build(ring, length);
+
+	offset = (ring->head - ring->start) % EE_SIZE_PAGE;
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	if(offset == 0)
+	{
+		previous = ((ring->head == ring->start) ? ring->start + ring->size : ring->head) - EE_SIZE_PAGE;
+		if(ring->index[(previous - ring->start) / EE_SIZE_PAGE] == IDX_EMPTY)
+		{
+			return HAL_OK;
+		}
+
+		state = STO_Read(ring->device, previous, ring->page, EE_SIZE_PAGE);
+		memcpy(&crc, &ring->page[LOG_PAGE_DATA], sizeof(crc));
+		if(state == HAL_OK && crc == LOG_UNSEALED)
+		{
+			state = LOG_RingSeal(ring, previous);
+		}
+		return state;
+	}
+
+	state = STO_Read(ring->device, ring->head - offset, ring->page, EE_SIZE_PAGE);
+
+	if(state == HAL_OK && !LOG_isPageValid(ring->page))
+	{
+		LOG_CrcErrors++;
+
+		ring->head += EE_SIZE_PAGE - offset;
+		if(ring->head >= ring->start + ring->size)
+		{
+			ring->head = ring->start;
+			ring->wrapped = 1;
+		}
+	}
+
+	return state;
+}
+
+/*
+ * LOG_RingAlign
+ * @brief
+ * Seal the page of the head of a circular area before a record older than the newest one (clock set back) :
+ * the record starts the next page. The records of a page then always follow the time, and a step
+ * back of the clock shows in the index (see IDX_isOrdered). Nothing is done at the start of a page.
+ * @param
+ * ring	:	Circular area
+ * data	:	Record to be written, starting with its timestamp
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_RingAlign(LOG_Ring_t * ring, uint8_t * data)
+{
+	HAL_StatusTypeDef state;
+	uint32_t offset = (ring->head - ring->start) % EE_SIZE_PAGE;
+	uint32_t timestamp;
+
+	memcpy(&timestamp, data, sizeof(timestamp));
+	if(ring->device == NULL || offset == 0 || timestamp >= ring->last)
+	{
+		return HAL_OK;
+	}
+
+	state = LOG_RingSeal(ring, ring->head - offset);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	ring->head += EE_SIZE_PAGE - offset;
+	if(ring->head >= ring->start + ring->size)
+	{
+		ring->head = ring->start;
+		ring->wrapped = 1;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * LOG_RingWrite
+ * @brief
+ * Write a record at the head of a circular area and move the head.
+ * The first record of a page is written with the next sequence number and the rest of the page at 0xFF
+ * (records of the previous lap cleared, CRC unsealed), the next ones are written alone. The last record
+ * of the page is followed by the CRC of the page, computed on its copy in RAM (see LOG_RingSeal).
+ * A record older than the newest one starts a new page (see LOG_RingAlign).
+ * If the record cannot be programmed, the head and the index are not changed.
+ * The head goes back to the start of the area when the end is reached.
+ * @param
+ * ring		:	Circular area
+ * data		:	Record to be written, starting with its timestamp
+ * length	:	Size of one record
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_RingWrite(LOG_Ring_t * ring, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state;
+	uint32_t offset, sequence = ring->sequence;
+
+	if(ring->device == NULL)
+	{
+		return HAL_ERROR;
+	}
+
+	state = LOG_RingAlign(ring, data);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+	offset = (ring->head - ring->start) % EE_SIZE_PAGE;
+
+	if(offset == 0)
+	{
+		sequence++;
+		memset(ring->page, 0xFF, EE_SIZE_PAGE);
+		memcpy(ring->page, data, length);
+		memcpy(&ring->page[LOG_PAGE_SEQUENCE], &sequence, sizeof(sequence));
+		state = STO_Program(ring->device, ring->head, ring->page, EE_SIZE_PAGE);
+	}
+	else
+	{
+		memcpy(&ring->page[offset], data, length);
+		state = STO_Program(ring->device, ring->head, &ring->page[offset], length);
+	}
+
+	//The record is not stored : the head and the index are left as they are, the next record takes its place
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	IDX_Update(ring, ring->head, data);
+	memcpy(&ring->last, data, sizeof(ring->last));
+	ring->sequence = sequence;
+
+	//No room for another record : the page is full
+	if(offset + 2 * length > LOG_PAGE_SEQUENCE)
+	{
+		state = LOG_RingSeal(ring, ring->head - offset);
+	}
+
+	ring->head = LOG_RingNext(ring, ring->head, length);
+	if(ring->head == ring->start)
+	{
+		ring->wrapped = 1;
+	}
+
+	return state;
+}
+
+/*
+ * LOG_RingScan
+ * @brief
+ * Read the records of a circular area from an address up to the head.
+ * The pages are streamed by chunks with a single read command up to the end of the area
+ * (see STO_Stream), the CRC of each page is checked and the records of a corrupted page are skipped.
+ * The scan stops at the first record after t1, unless the clock went back (see IDX_isOrdered).
+ * The visitor must not access the device.
+ * @param
+ * ring		:	Circular area
+ * length	:	Size of one record
+ * addr		:	Address of the first record to read
+ * t0		:	Records older than t0 are skipped
+ * t1		:	Records newer than t1 stop the scan
+ * visitor	:	Function called for each record of the time range
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_RingScan(LOG_Ring_t * ring, uint16_t length, uint32_t addr, uint32_t t0, uint32_t t1, LOG_Visitor_t visitor)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint32_t pages, size;
+
+	LOG_Scan.ring = ring;
+	LOG_Scan.length = length;
+	LOG_Scan.addr = addr;
+	LOG_Scan.count = LOG_RingDistance(ring, addr, length);
+	LOG_Scan.t0 = t0;
+	LOG_Scan.t1 = t1;
+	LOG_Scan.visitor = visitor;
+	LOG_Scan.ordered = IDX_isOrdered(ring);
+	LOG_Scan.done = 0;
+
+	//One stream up to the end of the area, a second one from its start if the records wrap
+	while(state == HAL_OK && LOG_Scan.count && !LOG_Scan.done)
+	{
+		LOG_Scan.page = LOG_Scan.addr - (LOG_Scan.addr - ring->start) % EE_SIZE_PAGE;
+
+		pages = (LOG_Scan.count + LOG_RECORDS_PER_PAGE(length) - 1) / LOG_RECORDS_PER_PAGE(length) + 1;
+		size = ring->start + ring->size - LOG_Scan.page;
+		if(size > pages * EE_SIZE_PAGE)
+		{
+			size = pages * EE_SIZE_PAGE;
+		}
+
+		state = STO_Stream(ring->device, LOG_Scan.page, size, (uint8_t *)LOG_PageBuffer, sizeof(LOG_PageBuffer), LOG_ScanChunk);
+	}
+
+	return state;
+}
+
+/*
+ * LOG_RingCount
+ * @brief
+ * Get the number of records stored in a circular area
+ * @param
+ * ring		:	Circular area
+ * length	:	Size of one record
+ * @return
+ * uint32_t : Number of records
+ */
+uint32_t LOG_RingCount(LOG_Ring_t * ring, uint16_t length)
+{
+	return LOG_RingDistance(ring, LOG_RingOldest(ring), length);
+}
+
+/*
+ * LOG_RingDistance
+ * @brief
+ * Get the number of records between an address and the head of a circular area
+ * @param
+ * ring		:	Circular area
+ * addr		:	Address of a record
+ * length	:	Size of one record
+ * @return
+ * uint32_t : Number of records to read from the address to reach the head
+ */
+uint32_t LOG_RingDistance(LOG_Ring_t * ring, uint32_t addr, uint16_t length)
+{
+	uint32_t total = (ring->size / EE_SIZE_PAGE) * LOG_RECORDS_PER_PAGE(length);
+	uint32_t distance = (LOG_RingOrdinal(ring, ring->head, length) + total - LOG_RingOrdinal(ring, addr, length)) % total;
+
+	if(distance == 0 && ring->wrapped)
+	{
+		distance = total;
+	}
+
+	return distance;
+}
+
+/*
+ * LOG_RingOldest
+ * @brief
+ * Get the address of the oldest record of a circular area
+ * @param
+ * ring : Circular area
+ * @return
+ * uint32_t : Address of the oldest record
+ */
+uint32_t LOG_RingOldest(LOG_Ring_t * ring)
+{
+	return ring->wrapped ? ring->head : ring->start;
+}
+
+/*
+ * LOG_RingNext
+ * @brief
+ * Get the address of the record following another one in a circular area
+ * The Bytes at the end of a page which cannot hold a whole record are skipped.
+ * @param
+ * ring		:	Circular area
+ * addr		:	Address of the current record
+ * length	:	Size of one record
+ * @return
+ * uint32_t : Address of the next record
+ */
+uint32_t LOG_RingNext(LOG_Ring_t * ring, uint32_t addr, uint16_t length)
+{
+	addr += length;
+	if((addr - ring->start) % EE_SIZE_PAGE + length > LOG_PAGE_SEQUENCE)
+	{
+		//Changement de page
+		addr += EE_SIZE_PAGE - (addr - ring->start) % EE_SIZE_PAGE;
+	}
+
+	if(addr >= ring->start + ring->size)
+	{
+		addr = ring->start;
+	}
+
+	return addr;
+}
+
+/*
+ * LOG_RecordVisitor
+ * @brief
+ * Give a record read by LOG_RingScan to the callback of LOG_Export or LOG_Query
+ * @param
+ * record : Record read
+ * @return
+ * none
+ */
+void LOG_RecordVisitor(uint8_t * record)
+{
+	LOG_UserCallback((LOG_Record_t *)record);
+}
+
+/*
+ * LOG_TierScan
+ * @brief
+ * Give the records of the overflow tier between two dates to the callback of LOG_Export or LOG_Query
+ * @param
+ * t0	:	Start of the time range in seconds since 01/01/2000 00:00:00
+ * t1	:	End of the time range in seconds since 01/01/2000 00:00:00 (included)
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef LOG_TierScan(uint32_t t0, uint32_t t1)
+{
+	if(LOG_Overflow == NULL)
+	{
+		return HAL_OK;
+	}
+
+	LOG_TierT0 = t0;
+	LOG_TierT1 = t1;
+
+	return FLOG_Export(LOG_Overflow, LOG_TierVisitor);
+}
+
+/*
+ * LOG_TierVisitor
+ * @brief
+ * Give a record read by LOG_TierScan to the callback, if it is in the time range
+ * @param
+ * record : Record read
+ * @return
+ * none
+ */
+void LOG_TierVisitor(uint8_t * record)
+{
+	LOG_Record_t * sample = (LOG_Record_t *)record;
+
+	if(sample->timestamp >= LOG_TierT0 && sample->timestamp <= LOG_TierT1)
+	{
+		LOG_UserCallback(sample);
+	}
+}
+
+/*
+ * LOG_ScanChunk
+ * @brief
+ * Handle a chunk of pages streamed by LOG_RingScan
+ * @param
+ * data		:	Pages read
+ * length	:	Number of Bytes (whole pages)
+ * @return
+ * uint8_t	:	0 = Stop the stream (end of the scan or wrap of the area)
+ * 				1 = Go on
+ */
+uint8_t LOG_ScanChunk(uint8_t * data, uint16_t length)
+{
+	uint8_t * page;
+	uint32_t pageAddr, timestamp;
+	uint8_t valid;
+
+	for(uint16_t offset = 0; offset < length; offset += EE_SIZE_PAGE)
+	{
+		page = &data[offset];
+		pageAddr = LOG_Scan.page;
+		LOG_Scan.page += EE_SIZE_PAGE;
+
+		//The next record is back at the start of the area
+		if(LOG_Scan.addr < pageAddr || LOG_Scan.addr >= pageAddr + EE_SIZE_PAGE)
+		{
+			return 0;
+		}
+
+		valid = LOG_isPageValid(page);
+		if(!valid)
+		{
+			LOG_CrcErrors++;
+		}
+
+		do
+		{
+			memcpy(&timestamp, &page[LOG_Scan.addr - pageAddr], sizeof(timestamp));
+
+			if(valid && timestamp != IDX_EMPTY)
+			{
+				if(timestamp > LOG_Scan.t1 && LOG_Scan.ordered)
+				{
+					LOG_Scan.done = 1;
+					return 0;
+				}
+
+				if(timestamp >= LOG_Scan.t0 && timestamp <= LOG_Scan.t1)
+				{
+					LOG_Scan.visitor(&page[LOG_Scan.addr - pageAddr]);
+				}
+			}
+
+			LOG_Scan.count--;
+			LOG_Scan.addr = LOG_RingNext(LOG_Scan.ring, LOG_Scan.addr, LOG_Scan.length);
+		}
+		while(LOG_Scan.count && LOG_Scan.addr > pageAddr && LOG_Scan.addr < pageAddr + EE_SIZE_PAGE);
+
+		if(!LOG_Scan.count)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * LOG_isPageValid
+ * @brief
+ * Check the CRC of a page. A page not sealed yet (CRC at LOG_UNSEALED) is valid, its records
+ * are read up to the first empty one.
+ * @param
+ * page : Content of the page (EE_SIZE_PAGE Bytes)
+ * @return
+ * uint8_t	: 	0 = Wrong CRC
+ * 				1 = Valid CRC, or page not full
+ */
+uint8_t LOG_isPageValid(uint8_t * page)
+{
+	uint32_t crc;
+
+	memcpy(&crc, &page[LOG_PAGE_DATA], sizeof(crc));
+
+	return crc == LOG_UNSEALED || CRC32_Compute(page, LOG_PAGE_DATA) == crc;
+}
+
+/*
+ * LOG_RingSeal
+ * @brief
+ * Write the CRC of a full page of a circular area, computed on the copy of the page in RAM
+ * @param
+ * ring	:	Circular area, its page in RAM holds the content of the page
+ * addr	:	Address of the page
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef LOG_RingSeal(LOG_Ring_t * ring, uint32_t addr)
+{
+	uint32_t crc = CRC32_Compute(ring->page, LOG_PAGE_DATA);
+
+	memcpy(&ring->page[LOG_PAGE_DATA], &crc, sizeof(crc));
+
+	return STO_Program(ring->device, addr + LOG_PAGE_DATA, &ring->page[LOG_PAGE_DATA], sizeof(crc));
+}
+
+/*
+ * LOG_RingOrdinal
+ * @brief
+ * Get the position of a record in a circular area
+ * @param
+ * ring		:	Circular area
+ * addr		:	Address of the record
+ * length	:	Size of one record
+ * @return
+ * uint32_t : Number of records stored before it from the start of the area
+ */
+uint32_t LOG_RingOrdinal(LOG_Ring_t * ring, uint32_t addr, uint16_t length)
+{
+	uint32_t offset = addr - ring->start;
+
+	return (offset / EE_SIZE_PAGE) * LOG_RECORDS_PER_PAGE(length) + (offset % EE_SIZE_PAGE) / length;
+}
+
+/*
+ * LOG_ChannelIndex
+ * @brief
+ * Get the position of a channel in the tables of the log
+ * @param
+ * channel : LOG_CHANNEL_xxx
+ * @return
+ * uint8_t : Index of the lowest bit set in the bitmap (0 to LOG_NB_CHANNELS - 1)
+ */
+uint8_t LOG_ChannelIndex(uint8_t channel)
+{
+	uint8_t index = 0;
+
+	while(index < LOG_NB_CHANNELS - 1 && !(channel & (1 << index)))
+	{
+		index++;
+	}
+
+	return index;
+}
+
+/*
+ * LOG_Evict
+ * @brief
+ * Before the head of the sample log enters the oldest page, move the records of this page into
+ * the overflow tier : they are packed without the padding and the CRC of the page, the records
+ * of a page with a wrong CRC are dropped. The records are programmed before the page is overwritten,
+ * if they could not be the page is overwritten all the same (see LOG_getTierErrors).
+ * A reset between the eviction and the first write of the page leaves the records in both places :
+ * the records up to the newest one of the tier are not moved again.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef LOG_Evict(void)
+{
+	HAL_StatusTypeDef state;
+	uint8_t page[EE_SIZE_PAGE];
+	LOG_Record_t newest;
+	uint32_t timestamp;
+	uint16_t first = 0;
+
+	if(LOG_Overflow == NULL || !LOG_RawRing.wrapped || (LOG_RawRing.head - LOG_RawRing.start) % EE_SIZE_PAGE)
+	{
+		return HAL_OK;
+	}
+
+	state = STO_Read(LOG_RawRing.device, LOG_RawRing.head, page, EE_SIZE_PAGE);
+	if(state != HAL_OK || !LOG_isPageValid(page))
+	{
+		return state;
+	}
+
+	state = FLOG_getNewest(LOG_Overflow, (uint8_t *)&newest);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	//Records of this page already in the tier
+	for(uint16_t offset = 0; offset + LOG_RECORD_SIZE <= LOG_PAGE_SEQUENCE; offset += LOG_RECORD_SIZE)
+	{
+		if(newest.timestamp != FLOG_EMPTY && memcmp(&page[offset], &newest, LOG_RECORD_SIZE) == 0)
+		{
+			first = offset + LOG_RECORD_SIZE;
+		}
+	}
+
+	for(uint16_t offset = first; offset + LOG_RECORD_SIZE <= LOG_PAGE_SEQUENCE; offset += LOG_RECORD_SIZE)
+	{
+		memcpy(&timestamp, &page[offset], sizeof(timestamp));
+		if(timestamp == IDX_EMPTY)
+		{
+			break;
+		}
+		FLOG_Append(LOG_Overflow, &page[offset]);
+	}
+
+	return FLOG_Flush(LOG_Overflow);
+}
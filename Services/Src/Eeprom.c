@@ -13,10 +13,71 @@
 /*
  * PRIVATE CONSTANTS
  */
+//Prescalers tried by EE_Tune, fastest first
+const uint32_t EE_Prescalers[] =
+{
+	SPI_BAUDRATEPRESCALER_2,
+	SPI_BAUDRATEPRESCALER_4,
+	SPI_BAUDRATEPRESCALER_8,
+	SPI_BAUDRATEPRESCALER_16,
+	SPI_BAUDRATEPRESCALER_32,
+	SPI_BAUDRATEPRESCALER_64,
+	SPI_BAUDRATEPRESCALER_128,
+	SPI_BAUDRATEPRESCALER_256
+};
+#define EE_NB_PRESCALERS		(sizeof(EE_Prescalers) / sizeof(uint32_t))
+
+#define EE_NO_FETCH				0xFF		// No page is being prefetched
+
+#define EE_TUNE_MAGIC			0x454E5554	// "TUNE", the scratch page holds the clock kept by EE_Tune
+#define EE_TUNE_PATTERN			(EE_SIZE_PAGE - sizeof(EE_TuneRecord_t))	// Bytes of the scratch page checked
+
+/*
+ * EE_Line_t definition
+ * Line of the read cache, a copy of one page of the EEPROM
+ * page		: Number of the page
+ * valid	: The data are a copy of the page
+ * used		: Date of the last access, the line used the longest ago is replaced
+ * data		: Content of the page
+ */
+typedef struct
+{
+	uint16_t page;
+	uint8_t valid;
+	uint32_t used;
+	uint8_t data[EE_SIZE_PAGE];
+} EE_Line_t;
+
+/*
+ * EE_TuneRecord_t definition
+ * Clock kept by EE_Tune, stored at the end of the scratch page after the reference pattern
+ * magic		: EE_TUNE_MAGIC
+ * prescaler	: SPI_BAUDRATEPRESCALER_x kept
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t prescaler;
+} EE_TuneRecord_t;
 
 /*
  * PRIVATE GLOBAL VARIABLES
  */
+uint32_t EE_Throughput = 0;				// Bytes/s of the reads measured by EE_Tune
+
+DMA_HandleTypeDef EE_hdmaTx;			// SPI2_TX -> DMA1 Channel 5
+DMA_HandleTypeDef EE_hdmaRx;			// SPI2_RX -> DMA1 Channel 4
+uint8_t EE_Dummy = 0xFF;				// Byte sent to clock the streamed reads
+uint8_t EE_Page[2][EE_SIZE_PAGE + 4];	// Write command and data of a page, one sent while the other is filled
+uint8_t EE_Buffer = 0;					// Page buffer to fill
+uint8_t EE_Sending = 0;					// The DMA sends a page, CS is still low
+uint8_t EE_Pending = 0;					// A page is being programmed
+
+EE_Line_t EE_Cache[EE_CACHE_LINES];
+uint32_t EE_CacheClock = 0;				// Date of the accesses to the lines
+uint8_t EE_Fetching = EE_NO_FETCH;		// Line filled by the DMA, CS is still low
+uint32_t EE_NextAddr = 0xFFFFFFFF;		// Address following the last read, to detect sequential reads
+EE_CacheStats_t EE_CacheStats = {0};
 
 
 /*
@@ -29,6 +90,23 @@ uint8_t EE_isEEPROMBusy();
 
 void EE_SPI_Disable();
 
+HAL_StatusTypeDef EE_Send(uint8_t * data, uint16_t length);
+HAL_StatusTypeDef EE_EndSend(void);
+HAL_StatusTypeDef EE_Receive(uint8_t * data, uint16_t length);
+HAL_StatusTypeDef EE_DmaInit(void);
+HAL_StatusTypeDef EE_Command(uint8_t opcode, uint32_t addr);
+
+EE_Line_t * EE_CacheFind(uint16_t page);
+EE_Line_t * EE_CacheVictim(void);
+void EE_CacheInvalidate(uint32_t addr, uint32_t length);
+void EE_Prefetch(uint16_t page);
+
+void EE_setPrescaler(uint32_t prescaler);
+HAL_StatusTypeDef EE_Search(uint32_t scratch);
+uint8_t EE_isPrescaler(uint32_t prescaler);
+void EE_Pattern(uint8_t * data, uint8_t seed);
+HAL_StatusTypeDef EE_Check(uint32_t addr, uint8_t seed, uint8_t passes);
+
 /***************************************************************************************/
 /*
  * EE_Init
@@ -48,6 +126,8 @@ HAL_StatusTypeDef EE_Init(uint16_t status)
 	HAL_StatusTypeDef state;
 
 	HAL_SPIEx_FlushRxFifo(&hspi2);
+	EE_Sending = 0;
+	EE_Pending = 0;
 
 	while(EE_isEEPROMBusy());
 
@@ -124,7 +204,7 @@ HAL_StatusTypeDef EE_ResetWriteEnable()
 	HAL_StatusTypeDef state;
 	uint8_t tmp = WRDI;
 
-	while(EE_isEEPROMBusy());
+	EE_Sync();
 
 	state = HAL_SPI_Transmit(&hspi2, &tmp, 1, HAL_MAX_DELAY);
 
@@ -156,13 +236,14 @@ HAL_StatusTypeDef EE_WriteStatusRegister(uint16_t status)
 	buf[1] = status&0xFF;
 	buf[2] = (status >> 8)&0xFF;
 
-	while(EE_isEEPROMBusy());
+	EE_Sync();
 
 	EE_SetWriteEnable();
 
 	state = HAL_SPI_Transmit(&hspi2, buf, 3, HAL_MAX_DELAY);
 
 	EE_SPI_Disable();
+	EE_Pending = 1;
 
 	return state;
 }
@@ -185,6 +266,8 @@ HAL_StatusTypeDef EE_ReadStatusRegister(uint16_t * status)
 	uint8_t send = RDSR;
 	uint8_t receive[2];
 
+	EE_Sync();
+
 	state = HAL_SPI_Transmit(&hspi2, &send, 1, HAL_MAX_DELAY);
 	state = HAL_SPI_Receive(&hspi2, receive, 2, HAL_MAX_DELAY);
 
@@ -201,137 +284,485 @@ HAL_StatusTypeDef EE_ReadStatusRegister(uint16_t * status)
  * @brief
  * Write up to 2^16 Bytes to EEPROM memory.
  * The EEPROM is able to write up to 256 Bytes with one write command.
- * This function cycles until there is no Bytes left to write.
+ * The data are split on the pages and written through two page buffers : the next page is assembled
+ * while the DMA sends the current one and while the EEPROM programs it. The EEPROM is polled only
+ * before the next command, the function returns while the last page is being programmed.
  *
  * Call the function EE_setWriteEnable() before each write cycle
  * @param
  * addr 	:	Start address of the the writing process
- * data		:	Buffer of data to be written
+ * data		:	Buffer of data to be written, free again at the return of the function
  * length	:	Number of Bytes to be written
  * @return
  * HAL_StatusTypeDef : Status of the communication
  * 					- HAL_OK
  * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
  */
 HAL_StatusTypeDef EE_Write(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint32_t part;
+
+	EE_Sync();
+	EE_CacheInvalidate(addr, length);
+
+	while(length && state == HAL_OK)
+	{
+		addr %= EE_SIZE_MEMORY;
+		part = EE_SIZE_PAGE - (addr & 0xFF);
+		if(part > length)
+		{
+			part = length;
+		}
+
+		//Assembled while the previous page is sent and programmed
+		EE_Page[EE_Buffer][0] = WRITE;
+		EE_Page[EE_Buffer][1] = (addr >> 16) & 0x0F;
+		EE_Page[EE_Buffer][2] = (addr >> 8) & 0xFF;
+		EE_Page[EE_Buffer][3] = addr & 0xFF;
+		memcpy(&EE_Page[EE_Buffer][4], data, part);
+
+		state = EE_Sync();
+		if(state == HAL_OK)
+		{
+			state = EE_SetWriteEnable();
+		}
+		if(state == HAL_OK)
+		{
+			state = EE_Send(EE_Page[EE_Buffer], part + 4);
+		}
+
+		EE_Buffer ^= 1;
+		addr += part;
+		data += part;
+		length -= part;
+	}
+
+	return state;
+}
+
+/*
+ * EE_Sync
+ * @brief
+ * Wait for the end of the last write : end of the DMA transfer, then end of the program cycle.
+ * Called before each command, the EEPROM is polled only if a write is pending.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the last write
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EE_Sync(void)
 {
 	HAL_StatusTypeDef state;
-	uint8_t buf[length+4];
 
-	uint32_t count = length;
+	state = EE_EndTransfer();
+
+	if(EE_Pending)
+	{
+		while(EE_isEEPROMBusy());
+		EE_Pending = 0;
+	}
+
+	return state;
+}
 
-	while(count)
+/*
+ * EE_isBusy
+ * @brief
+ * Check without waiting if the last write is still in progress : page still sent by the DMA,
+ * or program cycle of the EEPROM. A read-ahead of the cache does not make the EEPROM busy.
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 while the last write is in progress
+ */
+uint8_t EE_isBusy(void)
+{
+	if(EE_Sending)
 	{
-		if((addr&0xFF) + count >= EE_SIZE_PAGE)
+		if(__HAL_DMA_GET_COUNTER(&EE_hdmaTx) != 0)
 		{
-			//Ecriture au dela de la fin de la page
-			buf[0] = WRITE;
+			return 1;
+		}
+		EE_EndSend();
+	}
 
-			//address setting 24 bits of address
-			buf[1] = (addr >> 16) & 0x07;
-			buf[2] = (addr >> 8) & 0xFF;
-			buf[3] = addr & 0xFF;
+	if(EE_Pending && EE_Fetching == EE_NO_FETCH)
+	{
+		if(EE_isEEPROMBusy())
+		{
+			return 1;
+		}
+		EE_Pending = 0;
+	}
 
-			for(uint8_t i = 0; i<(EE_SIZE_PAGE - (addr&0xFF)); i++)
+	return 0;
+}
+
+/*
+ * EE_Read
+ * @brief
+ * Read the EEPROM memory through the read cache.
+ * Reads shorter than a page are served from the lines of the cache. A read following the previous one
+ * loads its page in the cache and starts the DMA read-ahead of the next page, a lone read goes
+ * straight to the EEPROM. Longer reads are not cached.
+ * @param
+ * addr			:	Address of start of reading
+ * ptr * data 	:	Pointer of buffer where the data will be saved
+ * length		:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_Read(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	EE_Vector_t vector = {data, length};
+	EE_Line_t * line = NULL;
+	uint8_t sequential = (addr == EE_NextAddr);
+	uint16_t page = 0, part;
+
+	EE_NextAddr = addr + length;
+
+	//Pages and more are read straight
+	if(length >= EE_SIZE_PAGE)
+	{
+		return EE_Readv(addr, &vector, 1);
+	}
+
+	while(length)
+	{
+		page = (addr / EE_SIZE_PAGE) % (EE_LAST_PAGE + 1);
+		part = EE_SIZE_PAGE - (addr % EE_SIZE_PAGE);
+		if(part > length)
+		{
+			part = length;
+		}
+
+		line = EE_CacheFind(page);
+		if(line != NULL)
+		{
+			EE_CacheStats.hits++;
+		}
+		else
+		{
+			EE_CacheStats.misses++;
+			if(!sequential)
 			{
-				buf[4+i] = data[length - count + i];
+				//A lone read does not load a whole page
+				vector.data = data;
+				vector.length = part;
+				if(EE_Readv(addr, &vector, 1) != HAL_OK)
+				{
+					return HAL_ERROR;
+				}
 			}
+			else
+			{
+				line = EE_CacheVictim();
+				line->page = page;
+				vector.data = line->data;
+				vector.length = EE_SIZE_PAGE;
+				if(EE_Readv(page * EE_SIZE_PAGE, &vector, 1) != HAL_OK)
+				{
+					return HAL_ERROR;
+				}
+				line->valid = 1;
+			}
+		}
 
-			while(EE_isEEPROMBusy());
+		if(line != NULL)
+		{
+			memcpy(data, &line->data[addr % EE_SIZE_PAGE], part);
+			line->used = ++EE_CacheClock;
+		}
 
-			state = EE_SetWriteEnable();
+		addr += part;
+		data += part;
+		length -= part;
+	}
 
-			state = HAL_SPI_Transmit(&hspi2, buf, (EE_SIZE_PAGE - (addr&0xFF)) + 4, HAL_MAX_DELAY);
+	//Read-ahead of the next page while this one is consumed
+	if(sequential && line != NULL)
+	{
+		EE_Prefetch((page + 1) % (EE_LAST_PAGE + 1));
+	}
 
-			EE_SPI_Disable();
+	return HAL_OK;
+}
 
-			count -= (EE_SIZE_PAGE - (addr&0xFF));
+/*
+ * EE_getCacheStats
+ * @brief
+ * Get the counters of the read cache since the reset
+ * @param
+ * stats : Counters of the cache
+ * @return
+ * none
+ */
+void EE_getCacheStats(EE_CacheStats_t * stats)
+{
+	*stats = EE_CacheStats;
+}
 
-			//Changement de page
-			uint16_t page = (addr >> 8) & 0x7FF;
-			page++;
-			addr = 0;
-			if(page > EE_LAST_PAGE)
-			{
-				//Revenir sur la première page
-				page = 0x00;
-			}
+/*
+ * EE_Writev
+ * @brief
+ * Write a list of buffers one after the other in the EEPROM memory (header and payload for example).
+ * The buffers are sent as they are, without copy, split on the pages of the EEPROM :
+ * each write command may take Bytes of several buffers. The function returns while the last page
+ * is being programmed (see EE_Sync), the buffers are free again.
+ * @param
+ * addr		:	Start address of the writing process
+ * vector	:	List of buffers
+ * count	:	Number of buffers
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EE_Writev(uint32_t addr, const EE_Vector_t * vector, uint8_t count)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint8_t cmd[4];
+	uint8_t index = 0;
+	uint16_t offset = 0;
+	uint32_t room, part, total = 0;
+
+	for(uint8_t k = 0; k < count; k++)
+	{
+		total += vector[k].length;
+	}
+	EE_Sync();
+	EE_CacheInvalidate(addr, total);
+
+	//Empty buffers are skipped
+	while(index < count && vector[index].length == 0)
+	{
+		index++;
+	}
 
-			buf[1] = (page >> 8) & 0x0F;
-			buf[2] = page & 0xFF;
-			buf[3] = addr;
+	while(index < count && state == HAL_OK)
+	{
+		addr %= EE_SIZE_MEMORY;
+
+		cmd[0] = WRITE;
+		cmd[1] = (addr >> 16) & 0x0F;
+		cmd[2] = (addr >> 8) & 0xFF;
+		cmd[3] = addr & 0xFF;
 
+		state = EE_Sync();
+		if(state == HAL_OK)
+		{
+			state = EE_SetWriteEnable();
 		}
-		else
+		if(state == HAL_OK)
 		{
-			//Ecriture sur une page
-			buf[0] = WRITE;
-
-			//address setting 24 bits of address
-			buf[1] = (addr >> 16) & 0x0F;
-			buf[2] = (addr >> 8) & 0xFF;
-			buf[3] = addr & 0xFF;
+			state = HAL_SPI_Transmit(&hspi2, cmd, 4, HAL_MAX_DELAY);
+		}
 
-			for(uint8_t i = 0; i<count; i++)
+		//Bytes of the buffers up to the end of the page, CS stays low
+		room = EE_SIZE_PAGE - (addr & 0xFF);
+		while(room && index < count && state == HAL_OK)
+		{
+			part = vector[index].length - offset;
+			if(part > room)
 			{
-				buf[4+i] = data[length - count + i];
+				part = room;
 			}
+			state = HAL_SPI_Transmit(&hspi2, vector[index].data + offset, part, HAL_MAX_DELAY);
 
-			while(EE_isEEPROMBusy());
+			room -= part;
+			addr += part;
+			offset += part;
+			if(offset == vector[index].length)
+			{
+				offset = 0;
+				do
+				{
+					index++;
+				} while(index < count && vector[index].length == 0);
+			}
+		}
 
-			state = EE_SetWriteEnable();
+		EE_SPI_Disable();
+		EE_Pending = 1;
+	}
 
-			state = HAL_SPI_Transmit(&hspi2, buf, count+4, HAL_MAX_DELAY);
+	return state;
+}
 
-			EE_SPI_Disable();
+/*
+ * EE_Readv
+ * @brief
+ * Read the EEPROM memory into a list of buffers, with a single read command.
+ * The Bytes go straight from SPI2 to the buffers, the stack use does not depend on the length.
+ * @param
+ * addr		:	Address of start of reading
+ * vector	:	List of buffers, filled one after the other
+ * count	:	Number of buffers
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_Readv(uint32_t addr, const EE_Vector_t * vector, uint8_t count)
+{
+	HAL_StatusTypeDef state;
 
-			while(EE_isEEPROMBusy());
+	EE_Sync();
 
-			count -= count;
+	state = EE_Command(READ, addr);
+	for(uint8_t k = 0; k < count && state == HAL_OK; k++)
+	{
+		if(vector[k].length)
+		{
+			state = HAL_SPI_Receive(&hspi2, vector[k].data, vector[k].length, HAL_MAX_DELAY);
 		}
 	}
 
+	EE_SPI_Disable();
+
 	return state;
 }
 
+
 /*
- * EE_Read
+ * EE_Stream
  * @brief
- * Read the EEPROM memory
+ * Read a range of the EEPROM memory of any length (up to the whole memory) with a single read command.
+ * The chunk buffer is split in two halves filled in turn by the DMA : the callback is given each
+ * half as soon as it is full, while the DMA fills the other one. The callback must not access the EEPROM.
  * @param
- * addr			:	Address of start of reading
- * ptr * data 	:	Pointer of buffer where the data will be saved
- * length		:	Number of Bytes to be read
+ * addr		:	Address of start of reading
+ * length	:	Number of Bytes to read
+ * buffer	:	Chunk buffer owned by the caller
+ * size		:	Size of the chunk buffer (each chunk is half of it)
+ * callback	:	Function called with each chunk, returns 0 to stop the read
  * @return
  * HAL_StatusTypeDef : Status of the communication
- * 					- HAL_OK
+ * 					- HAL_OK		range read, or read stopped by the callback
  * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
  */
-HAL_StatusTypeDef EE_Read(uint32_t addr, uint8_t * data, uint16_t length)
+HAL_StatusTypeDef EE_Stream(uint32_t addr, uint32_t length, uint8_t * buffer, uint16_t size, EE_Callback_t callback)
 {
 	HAL_StatusTypeDef state;
-	uint8_t send[4], receive[length];
-	//Lecture sur une page
-	send[0] = READ;
+	uint8_t * chunk = NULL;
+	uint16_t part, previous = 0;
+	uint8_t half = 0, stop = 0;
 
-	//address setting 24 bits of address
-	send[1] = (addr >> 16) & 0x0F;
-	send[2] = (addr >> 8) & 0xFF;
-	send[3] = addr & 0xFF;
+	if(size < 2 || length > EE_SIZE_MEMORY || EE_DmaInit() != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	size /= 2;
 
-	state = HAL_SPI_Transmit(&hspi2, send, 4, HAL_MAX_DELAY);
-	state = HAL_SPI_Receive(&hspi2, receive, length, HAL_MAX_DELAY);
+	EE_Sync();
 
-	EE_SPI_Disable();
+	state = EE_Command(READ, addr);
+	HAL_SPIEx_FlushRxFifo(&hspi2);
+	__HAL_SPI_CLEAR_OVRFLAG(&hspi2);
 
-	for(uint8_t i = 0; i<length; i++)
+	while(state == HAL_OK && (length || previous))
 	{
-		data[i] = receive[i];
+		part = (length > size) ? size : length;
+		if(part)
+		{
+			state = EE_Receive(buffer + half * size, part);
+		}
+
+		//The previous chunk is handled during the transfer of this one
+		if(previous && state == HAL_OK && !callback(chunk, previous))
+		{
+			stop = 1;
+		}
+
+		if(part)
+		{
+			//Both DMA channels end together, the RX one last
+			if(HAL_DMA_PollForTransfer(&EE_hdmaRx, HAL_DMA_FULL_TRANSFER, EE_TIMEOUT + (uint32_t)part * 8000 / EE_getClock()) != HAL_OK
+				|| HAL_DMA_PollForTransfer(&EE_hdmaTx, HAL_DMA_FULL_TRANSFER, EE_TIMEOUT) != HAL_OK)
+			{
+				HAL_DMA_Abort(&EE_hdmaRx);
+				HAL_DMA_Abort(&EE_hdmaTx);
+				state = HAL_TIMEOUT;
+			}
+			CLEAR_BIT(hspi2.Instance->CR2, SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+			SET_BIT(EE_hdmaTx.Instance->CCR, DMA_CCR_MINC);
+		}
+
+		chunk = buffer + half * size;
+		previous = stop ? 0 : part;
+		length = stop ? 0 : length - part;
+		half ^= 1;
 	}
 
+	EE_SPI_Disable();
+
 	return state;
 }
 
+/*
+ * EE_Select
+ * @brief
+ * Give SPI2 to another chip of the bus, selected by a GPIO : the DMA transfers of the EEPROM are
+ * ended, the NSS pin is held high as a GPIO and SPI2 manages NSS by software. A program cycle of the
+ * EEPROM goes on while the other chip is accessed, the next command of the EEPROM waits for it.
+ * The chip is then accessed with HAL_SPI_Transmit / HAL_SPI_Receive up to EE_Deselect.
+ * @param
+ * port	:	Port of the chip select
+ * pin	:	Pin of the chip select (active low)
+ * @return
+ * none
+ */
+void EE_Select(GPIO_TypeDef * port, uint16_t pin)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	EE_EndTransfer();
+
+	HAL_GPIO_WritePin(EE_NSS_PORT, EE_NSS_PIN, GPIO_PIN_SET);
+	GPIO_InitStruct.Pin = EE_NSS_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(EE_NSS_PORT, &GPIO_InitStruct);
+	SET_BIT(hspi2.Instance->CR1, SPI_CR1_SSM | SPI_CR1_SSI);
+
+	HAL_GPIO_WritePin(port, pin, GPIO_PIN_RESET);
+}
+
+/*
+ * EE_Deselect
+ * @brief
+ * Release a chip selected by EE_Select and give the NSS pin back to SPI2
+ * @param
+ * port	:	Port of the chip select
+ * pin	:	Pin of the chip select (active low)
+ * @return
+ * none
+ */
+void EE_Deselect(GPIO_TypeDef * port, uint16_t pin)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	EE_SPI_Disable();
+	HAL_GPIO_WritePin(port, pin, GPIO_PIN_SET);
+
+	CLEAR_BIT(hspi2.Instance->CR1, SPI_CR1_SSM | SPI_CR1_SSI);
+	GPIO_InitStruct.Pin = EE_NSS_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	GPIO_InitStruct.Alternate = GPIO_AF5_SPI2;
+	HAL_GPIO_Init(EE_NSS_PORT, &GPIO_InitStruct);
+}
 
 /*
  * EE_getID
@@ -350,12 +781,96 @@ void EE_getID(uint8_t * id)
 {
 	uint8_t buf = SPID;
 
+	EE_Sync();
+
 	HAL_SPI_Transmit(&hspi2, &buf, 1, HAL_MAX_DELAY);
 	HAL_SPI_Receive(&hspi2, id, 5, HAL_MAX_DELAY);
 
 	EE_SPI_Disable();
 }
 
+/*
+ * EE_Tune
+ * @brief
+ * Select the fastest clock of SPI2 the link with the EEPROM can follow.
+ * The scratch page keeps a reference pattern and the clock found by the last search : if the pattern
+ * still reads back EE_TUNE_PASSES times at this clock, it is kept without any write. Otherwise the
+ * clock is searched again (see EE_Search). The throughput of the reads is then measured at the clock kept.
+ * @param
+ * scratch : Address of the scratch page (aligned on a page), reserved for the self-test
+ * @return
+ * HAL_StatusTypeDef : Status of the self-test
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no reliable clock, SPI2 left at EE_PRESCALER_SAFE
+ */
+HAL_StatusTypeDef EE_Tune(uint32_t scratch)
+{
+	HAL_StatusTypeDef state = HAL_ERROR;
+	EE_TuneRecord_t record;
+	uint8_t page[EE_SIZE_PAGE];
+	uint32_t tickstart, bytes, addr;
+
+	EE_setPrescaler(EE_PRESCALER_SAFE);
+	if(EE_Read(scratch + EE_TUNE_PATTERN, (uint8_t *)&record, sizeof(record)) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	//Clock saved by a previous search, checked by reads only
+	if(record.magic == EE_TUNE_MAGIC && EE_isPrescaler(record.prescaler))
+	{
+		EE_setPrescaler(record.prescaler);
+		state = EE_Check(scratch, 0x00, EE_TUNE_PASSES);
+	}
+
+	if(state != HAL_OK)
+	{
+		state = EE_Search(scratch);
+	}
+
+	//Throughput of page reads at the clock kept
+	bytes = 0;
+	addr = 0;
+	tickstart = HAL_GetTick();
+	while(HAL_GetTick() - tickstart < EE_TUNE_TIME)
+	{
+		EE_Read(addr, page, EE_SIZE_PAGE);
+		bytes += EE_SIZE_PAGE;
+		addr = (addr + EE_SIZE_PAGE) % EE_SIZE_MEMORY;
+	}
+	EE_Throughput = bytes * 1000 / (HAL_GetTick() - tickstart);
+
+	return state;
+}
+
+/*
+ * EE_getClock
+ * @brief
+ * Get the clock of SPI2
+ * @param
+ * none
+ * @return
+ * uint32_t : Frequency of SCK (Hz)
+ */
+uint32_t EE_getClock(void)
+{
+	return HAL_RCC_GetPCLK1Freq() >> (((hspi2.Init.BaudRatePrescaler & SPI_CR1_BR) >> SPI_CR1_BR_Pos) + 1);
+}
+
+/*
+ * EE_getThroughput
+ * @brief
+ * Get the throughput of the reads measured by EE_Tune
+ * @param
+ * none
+ * @return
+ * uint32_t : Bytes/s, 0 before EE_Tune
+ */
+uint32_t EE_getThroughput(void)
+{
+	return EE_Throughput;
+}
+
 /*
  * EE_SPI_Disable
  * @brief
@@ -383,3 +898,502 @@ void EE_SPI_Disable()
 	HAL_SPIEx_FlushRxFifo(&hspi2);
 
 }
+
+/*
+ * EE_setPrescaler
+ * @brief
+ * Change the clock of SPI2, the SPI is disabled between two commands
+ * @param
+ * prescaler : SPI_BAUDRATEPRESCALER_x
+ * @return
+ * none
+ */
+void EE_setPrescaler(uint32_t prescaler)
+{
+	EE_Sync();
+	__HAL_SPI_DISABLE(&hspi2);
+	MODIFY_REG(hspi2.Instance->CR1, SPI_CR1_BR, prescaler);
+	hspi2.Init.BaudRatePrescaler = prescaler;
+}
+
+/*
+ * EE_Search
+ * @brief
+ * Search the fastest clock of SPI2 with the scratch page.
+ * A pattern is written at the clock of MX_SPI2_Init, then read back at each prescaler from the
+ * fastest one : the first prescaler passing EE_TUNE_PASSES read-backs, then a write and read-back
+ * of another pattern, is kept. The reference pattern is left in the page, followed by the prescaler
+ * kept for the next calls of EE_Tune.
+ * @param
+ * scratch : Address of the scratch page (aligned on a page)
+ * @return
+ * HAL_StatusTypeDef : Status of the self-test
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no reliable clock, SPI2 left at EE_PRESCALER_SAFE
+ */
+HAL_StatusTypeDef EE_Search(uint32_t scratch)
+{
+	HAL_StatusTypeDef state = HAL_ERROR;
+	EE_TuneRecord_t record = {EE_TUNE_MAGIC, EE_PRESCALER_SAFE};
+	uint8_t page[EE_SIZE_PAGE];
+
+	//Reference pattern, written at the known clock
+	EE_setPrescaler(EE_PRESCALER_SAFE);
+	EE_Pattern(page, 0x00);
+	if(EE_Write(scratch, page, EE_SIZE_PAGE) != HAL_OK || EE_Check(scratch, 0x00, 1) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	for(uint8_t k = 0; k < EE_NB_PRESCALERS && state != HAL_OK; k++)
+	{
+		EE_setPrescaler(EE_Prescalers[k]);
+		if(EE_Check(scratch, 0x00, EE_TUNE_PASSES) != HAL_OK)
+		{
+			continue;
+		}
+
+		//The writes must go through too : inverted pattern, then back to the reference one
+		EE_Pattern(page, 0xFF);
+		if(EE_Write(scratch, page, EE_SIZE_PAGE) == HAL_OK && EE_Check(scratch, 0xFF, 1) == HAL_OK)
+		{
+			state = HAL_OK;
+			record.prescaler = EE_Prescalers[k];
+		}
+		else
+		{
+			EE_setPrescaler(EE_PRESCALER_SAFE);
+		}
+		EE_Pattern(page, 0x00);
+		if(state == HAL_OK)
+		{
+			memcpy(&page[EE_TUNE_PATTERN], &record, sizeof(record));
+		}
+		if(EE_Write(scratch, page, EE_SIZE_PAGE) != HAL_OK)
+		{
+			state = HAL_ERROR;
+		}
+	}
+	if(state != HAL_OK)
+	{
+		EE_setPrescaler(EE_PRESCALER_SAFE);
+	}
+
+	return state;
+}
+
+/*
+ * EE_isPrescaler
+ * @brief
+ * Check that a value read from the scratch page is one of the prescalers tried by EE_Search
+ * @param
+ * prescaler : Value to check
+ * @return
+ * uint8_t : 1 if it is a SPI_BAUDRATEPRESCALER_x
+ */
+uint8_t EE_isPrescaler(uint32_t prescaler)
+{
+	for(uint8_t k = 0; k < EE_NB_PRESCALERS; k++)
+	{
+		if(EE_Prescalers[k] == prescaler)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * EE_Pattern
+ * @brief
+ * Fill a page with a test pattern : every Byte value, in an order toggling most bits
+ * between two Bytes
+ * @param
+ * data	:	Page to fill
+ * seed	:	Value XORed with the pattern
+ * @return
+ * none
+ */
+void EE_Pattern(uint8_t * data, uint8_t seed)
+{
+	for(uint16_t i = 0; i < EE_SIZE_PAGE; i++)
+	{
+		data[i] = (uint8_t)(i * 0xA7 + 0x5A) ^ seed;
+	}
+}
+
+/*
+ * EE_Check
+ * @brief
+ * Read back a page and compare it with the test pattern, up to the record of EE_Tune
+ * @param
+ * addr		:	Address of the page
+ * seed		:	Seed of the pattern (see EE_Pattern)
+ * passes	:	Number of read-backs
+ * @return
+ * HAL_StatusTypeDef : Status of the check
+ * 					- HAL_OK
+ * 					- HAL_ERROR		a Byte differs
+ */
+HAL_StatusTypeDef EE_Check(uint32_t addr, uint8_t seed, uint8_t passes)
+{
+	uint8_t expected[EE_SIZE_PAGE];
+	uint8_t page[EE_SIZE_PAGE];
+
+	EE_Pattern(expected, seed);
+	for(uint8_t n = 0; n < passes; n++)
+	{
+		if(EE_Read(addr, page, EE_SIZE_PAGE) != HAL_OK || memcmp(page, expected, EE_TUNE_PATTERN) != 0)
+		{
+			return HAL_ERROR;
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * EE_Send
+ * @brief
+ * Start the DMA transfer of a command, CS stays low until EE_Sync
+ * @param
+ * data		:	Command and data, must stay valid until EE_Sync
+ * length	:	Number of Bytes
+ * @return
+ * HAL_StatusTypeDef : Status of the start
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_Send(uint8_t * data, uint16_t length)
+{
+	if(EE_DmaInit() != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	if(HAL_DMA_Start(&EE_hdmaTx, (uint32_t)data, (uint32_t)&hspi2.Instance->DR, length) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+
+	//8-bit frames : the TX FIFO is filled Byte by Byte
+	SET_BIT(hspi2.Instance->CR2, SPI_CR2_TXDMAEN);
+	__HAL_SPI_ENABLE(&hspi2);
+	EE_Sending = 1;
+
+	return HAL_OK;
+}
+
+/*
+ * EE_EndTransfer
+ * @brief
+ * End the DMA transfers on SPI2 : read-ahead of the cache, then page sent by EE_Write.
+ * The program cycle of the page goes on, EE_Pending stays set.
+ * EE_Write returns with CS low while the DMA sends the last page : this function must be called
+ * before a sleep so that the page is programmed and the EEPROM goes to standby.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the page sent
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EE_EndTransfer(void)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+
+	if(EE_Fetching != EE_NO_FETCH)
+	{
+		if(HAL_DMA_PollForTransfer(&EE_hdmaRx, HAL_DMA_FULL_TRANSFER, EE_TIMEOUT) == HAL_OK
+			&& HAL_DMA_PollForTransfer(&EE_hdmaTx, HAL_DMA_FULL_TRANSFER, EE_TIMEOUT) == HAL_OK)
+		{
+			EE_Cache[EE_Fetching].valid = 1;
+		}
+		else
+		{
+			HAL_DMA_Abort(&EE_hdmaRx);
+			HAL_DMA_Abort(&EE_hdmaTx);
+		}
+		CLEAR_BIT(hspi2.Instance->CR2, SPI_CR2_TXDMAEN | SPI_CR2_RXDMAEN);
+		SET_BIT(EE_hdmaTx.Instance->CCR, DMA_CCR_MINC);
+		EE_SPI_Disable();
+		EE_Fetching = EE_NO_FETCH;
+	}
+
+	if(EE_Sending)
+	{
+		state = EE_EndSend();
+	}
+
+	return state;
+}
+
+/*
+ * EE_EndSend
+ * @brief
+ * End the DMA transfer of a page started by EE_Send, the release of CS starts the program cycle
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the transfer
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EE_EndSend(void)
+{
+	HAL_StatusTypeDef state;
+
+	state = HAL_DMA_PollForTransfer(&EE_hdmaTx, HAL_DMA_FULL_TRANSFER, EE_TIMEOUT);
+	if(state != HAL_OK)
+	{
+		HAL_DMA_Abort(&EE_hdmaTx);
+	}
+	CLEAR_BIT(hspi2.Instance->CR2, SPI_CR2_TXDMAEN);
+
+	EE_SPI_Disable();
+	__HAL_SPI_CLEAR_OVRFLAG(&hspi2);
+	EE_Sending = 0;
+	EE_Pending = 1;
+
+	return state;
+}
+
+/*
+ * EE_Receive
+ * @brief
+ * Start the DMA transfers of a chunk of a read : the RX channel stores the Bytes,
+ * the TX channel clocks them with a dummy Byte
+ * @param
+ * data		:	Chunk to fill
+ * length	:	Number of Bytes
+ * @return
+ * HAL_StatusTypeDef : Status of the start
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_Receive(uint8_t * data, uint16_t length)
+{
+	//RX first so that no Byte is lost
+	SET_BIT(hspi2.Instance->CR2, SPI_CR2_RXDMAEN);
+	if(HAL_DMA_Start(&EE_hdmaRx, (uint32_t)&hspi2.Instance->DR, (uint32_t)data, length) != HAL_OK)
+	{
+		CLEAR_BIT(hspi2.Instance->CR2, SPI_CR2_RXDMAEN);
+		return HAL_ERROR;
+	}
+
+	CLEAR_BIT(EE_hdmaTx.Instance->CCR, DMA_CCR_MINC);
+	if(HAL_DMA_Start(&EE_hdmaTx, (uint32_t)&EE_Dummy, (uint32_t)&hspi2.Instance->DR, length) != HAL_OK)
+	{
+		HAL_DMA_Abort(&EE_hdmaRx);
+		SET_BIT(EE_hdmaTx.Instance->CCR, DMA_CCR_MINC);
+		CLEAR_BIT(hspi2.Instance->CR2, SPI_CR2_RXDMAEN);
+		return HAL_ERROR;
+	}
+	SET_BIT(hspi2.Instance->CR2, SPI_CR2_TXDMAEN);
+
+	return HAL_OK;
+}
+
+/*
+ * EE_DmaInit
+ * @brief
+ * Configure the DMA channels of SPI2 the first time they are needed (Bytes, normal mode)
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_DmaInit(void)
+{
+	if(EE_hdmaTx.Instance != NULL)
+	{
+		return HAL_OK;
+	}
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	EE_hdmaTx.Instance = DMA1_Channel5;
+	EE_hdmaTx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+	EE_hdmaTx.Init.PeriphInc = DMA_PINC_DISABLE;
+	EE_hdmaTx.Init.MemInc = DMA_MINC_ENABLE;
+	EE_hdmaTx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	EE_hdmaTx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	EE_hdmaTx.Init.Mode = DMA_NORMAL;
+	EE_hdmaTx.Init.Priority = DMA_PRIORITY_MEDIUM;
+
+	EE_hdmaRx.Instance = DMA1_Channel4;
+	EE_hdmaRx.Init = EE_hdmaTx.Init;
+	EE_hdmaRx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+	EE_hdmaRx.Init.Priority = DMA_PRIORITY_HIGH;
+
+	if(HAL_DMA_Init(&EE_hdmaTx) != HAL_OK || HAL_DMA_Init(&EE_hdmaRx) != HAL_OK)
+	{
+		EE_hdmaTx.Instance = NULL;
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * EE_Command
+ * @brief
+ * Send a command followed by an address, CS stays low for the data
+ * @param
+ * opcode	:	Command (READ, WRITE)
+ * addr		:	Address in the EEPROM
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EE_Command(uint8_t opcode, uint32_t addr)
+{
+	uint8_t cmd[4];
+
+	cmd[0] = opcode;
+
+	//address setting 24 bits of address
+	cmd[1] = (addr >> 16) & 0x0F;
+	cmd[2] = (addr >> 8) & 0xFF;
+	cmd[3] = addr & 0xFF;
+
+	return HAL_SPI_Transmit(&hspi2, cmd, 4, HAL_MAX_DELAY);
+}
+
+/*
+ * EE_CacheFind
+ * @brief
+ * Find the line holding a page, the prefetch of this page is waited for
+ * @param
+ * page : Number of the page
+ * @return
+ * EE_Line_t * : Line of the page, NULL if the page is not in the cache
+ */
+EE_Line_t * EE_CacheFind(uint16_t page)
+{
+	if(EE_Fetching != EE_NO_FETCH && EE_Cache[EE_Fetching].page == page)
+	{
+		EE_Sync();
+	}
+
+	for(uint8_t k = 0; k < EE_CACHE_LINES; k++)
+	{
+		if(EE_Cache[k].valid && EE_Cache[k].page == page)
+		{
+			return &EE_Cache[k];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * EE_CacheVictim
+ * @brief
+ * Take the line to replace : an empty line, or else the line used the longest ago
+ * @param
+ * none
+ * @return
+ * EE_Line_t * : Line, invalidated
+ */
+EE_Line_t * EE_CacheVictim(void)
+{
+	EE_Line_t * line = &EE_Cache[0];
+
+	//The line being filled is released first
+	EE_Sync();
+
+	for(uint8_t k = 0; k < EE_CACHE_LINES; k++)
+	{
+		if(!EE_Cache[k].valid)
+		{
+			line = &EE_Cache[k];
+			break;
+		}
+		if(EE_Cache[k].used < line->used)
+		{
+			line = &EE_Cache[k];
+		}
+	}
+
+	line->valid = 0;
+
+	return line;
+}
+
+/*
+ * EE_CacheInvalidate
+ * @brief
+ * Drop the lines of the pages written
+ * @param
+ * addr		:	First address written
+ * length	:	Number of Bytes written
+ * @return
+ * none
+ */
+void EE_CacheInvalidate(uint32_t addr, uint32_t length)
+{
+	uint32_t first = addr / EE_SIZE_PAGE;
+	uint32_t pages = (addr % EE_SIZE_PAGE + length + EE_SIZE_PAGE - 1) / EE_SIZE_PAGE;
+
+	if(length == 0)
+	{
+		return;
+	}
+
+	for(uint8_t k = 0; k < EE_CACHE_LINES; k++)
+	{
+		if((EE_Cache[k].page + EE_LAST_PAGE + 1 - first) % (EE_LAST_PAGE + 1) < pages)
+		{
+			EE_Cache[k].valid = 0;
+		}
+	}
+}
+
+/*
+ * EE_Prefetch
+ * @brief
+ * Start the DMA read of a page into a line of the cache, the transfer ends in EE_Sync
+ * @param
+ * page : Number of the page
+ * @return
+ * none
+ */
+void EE_Prefetch(uint16_t page)
+{
+	EE_Line_t * line;
+
+	if(EE_CacheFind(page) != NULL || EE_DmaInit() != HAL_OK)
+	{
+		return;
+	}
+
+	line = EE_CacheVictim();
+	line->page = page;
+
+	if(EE_Command(READ, page * EE_SIZE_PAGE) != HAL_OK)
+	{
+		EE_SPI_Disable();
+		return;
+	}
+	HAL_SPIEx_FlushRxFifo(&hspi2);
+	__HAL_SPI_CLEAR_OVRFLAG(&hspi2);
+
+	if(EE_Receive(line->data, EE_SIZE_PAGE) != HAL_OK)
+	{
+		SET_BIT(EE_hdmaTx.Instance->CCR, DMA_CCR_MINC);
+		EE_SPI_Disable();
+		return;
+	}
+
+	//Used now, so that the next reads do not replace it before it is consumed
+	line->used = ++EE_CacheClock;
+	EE_Fetching = line - EE_Cache;
+	EE_CacheStats.prefetches++;
+}
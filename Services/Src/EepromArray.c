@@ -0,0 +1,438 @@
+/*
+ * EepromArray.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "EepromArray.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define EEA_ID_SIZE				5			// Bytes of the ID read by SPID (see EE_getID)
+
+/*
+ * EEA_Geometry_t definition
+ * Geometry of the stripe, stored on the first EEPROM, 8 Bytes
+ * magic	: EEA_MAGIC
+ * chips	: Number of chips of the stripe at its first start
+ * check	: Complement of chips
+ */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t chips;
+	uint16_t check;
+} EEA_Geometry_t;
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+const uint16_t EEA_CsPin[EEA_MAX_CHIPS] = {0, EEA_CS_PIN_1, EEA_CS_PIN_2, EEA_CS_PIN_3};	// The first chip has the hardware NSS
+uint8_t EEA_Chips = 1;					// EEPROMs found by EEA_Init
+uint8_t EEA_Pending = 0;				// Bitmap of the chips (except the first one) in their write cycle
+uint8_t EEA_Changed = 0;				// The chips found differ from the stored geometry
+STO_Device_t EEA_Device = {EE_SIZE_MEMORY, EE_SIZE_PAGE, STO_NO_ERASE, EEA_Read, EEA_Program, NULL, EEA_isBusy, NULL};
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef EEA_CheckGeometry(uint32_t geometry);
+uint32_t EEA_Locate(uint32_t addr, uint8_t * chip);
+HAL_StatusTypeDef EEA_Command(uint8_t chip, uint8_t opcode, uint32_t addr);
+HAL_StatusTypeDef EEA_Wait(uint8_t chip);
+uint8_t EEA_isChipBusy(uint8_t chip);
+
+
+/***************************************************************************************/
+/*
+ * EEA_Init
+ * @brief
+ * Look for the EEPROMs added on the chip selects EEA_CS_PIN_x, in this order : a chip is kept
+ * if it gives the same ID as the first EEPROM. The search stops at the first missing chip.
+ * The number of chips found is then checked against the geometry stored on the first EEPROM.
+ * @param
+ * geometry	:	Page of the geometry on the first EEPROM (LOG_STRIPE_START)
+ * @return
+ * HAL_StatusTypeDef : Status of the probe
+ * 					- HAL_OK
+ * 					- HAL_ERROR		the first EEPROM does not answer, or the stripe changed
+ */
+HAL_StatusTypeDef EEA_Init(uint32_t geometry)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint8_t reference[EEA_ID_SIZE], id[EEA_ID_SIZE];
+	uint8_t cmd = SPID;
+
+	EEA_Chips = 1;
+	EEA_Pending = 0;
+	EEA_Changed = 0;
+	EEA_Device.size = EE_SIZE_MEMORY;
+
+	EE_getID(reference);
+	if(reference[0] == 0x00 || reference[0] == 0xFF)
+	{
+		return HAL_ERROR;
+	}
+
+	for(uint8_t chip = 1; chip < EEA_MAX_CHIPS; chip++)
+	{
+		HAL_GPIO_WritePin(EEA_CS_PORT, EEA_CsPin[chip], GPIO_PIN_SET);
+		GPIO_InitStruct.Pin = EEA_CsPin[chip];
+		GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+		GPIO_InitStruct.Pull = GPIO_NOPULL;
+		GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+		HAL_GPIO_Init(EEA_CS_PORT, &GPIO_InitStruct);
+
+		EE_Select(EEA_CS_PORT, EEA_CsPin[chip]);
+		HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+		HAL_SPI_Receive(&hspi2, id, EEA_ID_SIZE, HAL_MAX_DELAY);
+		EE_Deselect(EEA_CS_PORT, EEA_CsPin[chip]);
+
+		if(memcmp(id, reference, EEA_ID_SIZE) != 0)
+		{
+			break;
+		}
+		EEA_Chips++;
+	}
+
+	EEA_Device.size = EEA_Chips * EE_SIZE_MEMORY;
+
+	return EEA_CheckGeometry(geometry);
+}
+
+/*
+ * EEA_getChips
+ * @brief
+ * Get the number of EEPROMs found by EEA_Init
+ * @param
+ * none
+ * @return
+ * uint8_t : Number of chips of the stripe (1 to EEA_MAX_CHIPS)
+ */
+uint8_t EEA_getChips(void)
+{
+	return EEA_Chips;
+}
+
+/*
+ * EEA_getDevice
+ * @brief
+ * Get the storage device of the stripe, the EEPROM alone (STO_Eeprom) if no other chip was found
+ * @param
+ * none
+ * @return
+ * const STO_Device_t * : Device of EEA_Chips * EE_SIZE_MEMORY Bytes,
+ * 						  NULL if the chips differ from the stored geometry
+ */
+const STO_Device_t * EEA_getDevice(void)
+{
+	if(EEA_Changed)
+	{
+		return NULL;
+	}
+	if(EEA_Chips == 1)
+	{
+		return &STO_Eeprom;
+	}
+
+	return &EEA_Device;
+}
+
+/*
+ * EEA_Read
+ * @brief
+ * Read the stripe page by page, each chip after the end of its write cycle
+ * @param
+ * addr		:	Address of start of reading
+ * data		:	Buffer of the Bytes read
+ * length	:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EEA_Read(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint32_t local;
+	uint16_t part;
+	uint8_t chip;
+
+	while(length && state == HAL_OK)
+	{
+		local = EEA_Locate(addr, &chip);
+		part = EE_SIZE_PAGE - (addr % EE_SIZE_PAGE);
+		if(part > length)
+		{
+			part = length;
+		}
+
+		if(chip == 0)
+		{
+			state = EE_Read(local, data, part);
+		}
+		else
+		{
+			state = EEA_Wait(chip);
+			if(state == HAL_OK)
+			{
+				state = EEA_Command(chip, READ, local);
+			}
+			if(state == HAL_OK)
+			{
+				state = HAL_SPI_Receive(&hspi2, data, part, HAL_MAX_DELAY);
+			}
+			EE_Deselect(EEA_CS_PORT, EEA_CsPin[chip]);
+		}
+
+		addr += part;
+		data += part;
+		length -= part;
+	}
+
+	return state;
+}
+
+/*
+ * EEA_Program
+ * @brief
+ * Write the stripe page by page. The page of a chip is sent while the previous chips are still
+ * in their write cycle, a chip is waited for only when it is written again : only a program of
+ * several pages, or two programs on different chips, overlap the write cycles.
+ * The function returns while the last pages are being programmed (see EEA_isBusy).
+ * @param
+ * addr		:	Start address of the writing process
+ * data		:	Buffer of data to be written, free again at the return of the function
+ * length	:	Number of Bytes to be written
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EEA_Program(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint32_t local;
+	uint16_t part;
+	uint8_t chip, cmd = WREN;
+
+	while(length && state == HAL_OK)
+	{
+		local = EEA_Locate(addr, &chip);
+		part = EE_SIZE_PAGE - (addr % EE_SIZE_PAGE);
+		if(part > length)
+		{
+			part = length;
+		}
+
+		if(chip == 0)
+		{
+			//Counted for the wear of the EEPROM, this program is already in the statistics of the stripe
+			state = EE_Write(local, data, part);
+			if(state == HAL_OK)
+			{
+				STO_Count(&STO_Eeprom, local, part);
+			}
+		}
+		else
+		{
+			state = EEA_Wait(chip);
+			if(state == HAL_OK)
+			{
+				EE_Select(EEA_CS_PORT, EEA_CsPin[chip]);
+				state = HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+				EE_Deselect(EEA_CS_PORT, EEA_CsPin[chip]);
+			}
+			if(state == HAL_OK)
+			{
+				state = EEA_Command(chip, WRITE, local);
+				if(state == HAL_OK)
+				{
+					state = HAL_SPI_Transmit(&hspi2, data, part, HAL_MAX_DELAY);
+				}
+				EE_Deselect(EEA_CS_PORT, EEA_CsPin[chip]);
+				EEA_Pending |= 1 << chip;
+			}
+		}
+
+		addr += part;
+		data += part;
+		length -= part;
+	}
+
+	return state;
+}
+
+/*
+ * EEA_isBusy
+ * @brief
+ * Check without waiting if a chip of the stripe is still in its write cycle
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 while a chip is busy
+ */
+uint8_t EEA_isBusy(void)
+{
+	uint8_t busy = EE_isBusy();
+
+	for(uint8_t chip = 1; chip < EEA_Chips; chip++)
+	{
+		if((EEA_Pending & (1 << chip)) && !EEA_isChipBusy(chip))
+		{
+			EEA_Pending &= ~(1 << chip);
+		}
+	}
+
+	return (busy || EEA_Pending) ? 1 : 0;
+}
+
+/*
+ * EEA_CheckGeometry
+ * @brief
+ * Compare the number of chips found with the one stored on the first EEPROM.
+ * The geometry is written at the first start, when the page is still empty.
+ * @param
+ * geometry	:	Page of the geometry on the first EEPROM
+ * @return
+ * HAL_StatusTypeDef : Status of the check
+ * 					- HAL_OK
+ * 					- HAL_ERROR		the stripe changed, or the page cannot be read
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EEA_CheckGeometry(uint32_t geometry)
+{
+	EEA_Geometry_t stored;
+
+	if(EE_Read(geometry, (uint8_t *)&stored, sizeof(stored)) != HAL_OK)
+	{
+		EEA_Changed = 1;
+		return HAL_ERROR;
+	}
+
+	if(stored.magic == EEA_MAGIC && stored.check == (uint16_t)~stored.chips)
+	{
+		if(stored.chips != EEA_Chips)
+		{
+			EEA_Changed = 1;
+			return HAL_ERROR;
+		}
+		return HAL_OK;
+	}
+
+	//First start of the stripe
+	stored.magic = EEA_MAGIC;
+	stored.chips = EEA_Chips;
+	stored.check = ~stored.chips;
+
+	return STO_Program(&STO_Eeprom, geometry, (uint8_t *)&stored, sizeof(stored));
+}
+
+/*
+ * EEA_Locate
+ * @brief
+ * Find the chip of an address of the stripe and the address in this chip
+ * @param
+ * addr	:	Address of the stripe
+ * chip	:	Number of the chip
+ * @return
+ * uint32_t : Address in the chip
+ */
+uint32_t EEA_Locate(uint32_t addr, uint8_t * chip)
+{
+	uint32_t page = addr / EE_SIZE_PAGE;
+
+	*chip = page % EEA_Chips;
+
+	return (page / EEA_Chips) * EE_SIZE_PAGE + addr % EE_SIZE_PAGE;
+}
+
+/*
+ * EEA_Command
+ * @brief
+ * Select an added chip and send a command followed by an address, CS stays low for the data
+ * up to EE_Deselect
+ * @param
+ * chip		:	Number of the chip (1 to EEA_Chips - 1)
+ * opcode	:	Command (READ, WRITE)
+ * addr		:	Address in the chip
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef EEA_Command(uint8_t chip, uint8_t opcode, uint32_t addr)
+{
+	uint8_t cmd[4];
+
+	cmd[0] = opcode;
+	cmd[1] = (addr >> 16) & 0x0F;
+	cmd[2] = (addr >> 8) & 0xFF;
+	cmd[3] = addr & 0xFF;
+
+	EE_Select(EEA_CS_PORT, EEA_CsPin[chip]);
+
+	return HAL_SPI_Transmit(&hspi2, cmd, 4, HAL_MAX_DELAY);
+}
+
+/*
+ * EEA_Wait
+ * @brief
+ * Wait for the end of the write cycle of an added chip
+ * @param
+ * chip : Number of the chip (1 to EEA_Chips - 1)
+ * @return
+ * HAL_StatusTypeDef : Status of the chip
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef EEA_Wait(uint8_t chip)
+{
+	uint32_t tickstart = HAL_GetTick();
+
+	if(!(EEA_Pending & (1 << chip)))
+	{
+		return HAL_OK;
+	}
+
+	while(EEA_isChipBusy(chip))
+	{
+		if(HAL_GetTick() - tickstart > EEA_TIMEOUT_WRITE)
+		{
+			return HAL_TIMEOUT;
+		}
+	}
+	EEA_Pending &= ~(1 << chip);
+
+	return HAL_OK;
+}
+
+/*
+ * EEA_isChipBusy
+ * @brief
+ * Read the Ready/Busy bit of an added chip (see EE_isEEPROMBusy)
+ * @param
+ * chip : Number of the chip (1 to EEA_Chips - 1)
+ * @return
+ * uint8_t : Not 0 while the chip is busy
+ */
+uint8_t EEA_isChipBusy(uint8_t chip)
+{
+	uint8_t cmd = WRBP;
+	uint8_t status = 0;
+
+	EE_Select(EEA_CS_PORT, EEA_CsPin[chip]);
+	HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+	HAL_SPI_Receive(&hspi2, &status, 1, HAL_MAX_DELAY);
+	EE_Deselect(EEA_CS_PORT, EEA_CsPin[chip]);
+
+	return status;
+}
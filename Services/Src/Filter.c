@@ -0,0 +1,374 @@
+/*
+ * Filter.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Filter.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define FLT_IIR_STRIDE			6			// Stored coefficients of a section : 3 pairs
+#define FLT_IIR_STATE			4			// x[n-1], x[n-2], y[n-1], y[n-2]
+
+#ifdef STO_HOST
+//Builds on a Linux host (-DSTO_HOST) : C versions of the DSP instructions of the Cortex-M4
+#define __SMLAD(x, y, sum)		FLT_Smlad((x), (y), (sum))
+#define __PKHBT(x, y, shift)	(((uint32_t)(x) & 0x0000FFFF) | (((uint32_t)(y) << (shift)) & 0xFFFF0000))
+#endif
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+int16_t FLT_Work[FLT_FIR_MAX_TAPS + FLT_BLOCK_MAX] __attribute__((aligned(4)));	// Last inputs followed by the block
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void FLT_Prime(FLT_Filter_t * filter, int16_t sample);
+void FLT_Fir(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride);
+void FLT_Iir(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride);
+void FLT_Median(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride);
+uint32_t FLT_Pair(const int16_t * data);
+#ifdef STO_HOST
+int32_t FLT_Smlad(uint32_t x, uint32_t y, int32_t sum);
+#endif
+
+
+/***************************************************************************************/
+/*
+ * FLT_Init
+ * @brief
+ * Initialize a filter.
+ * The coefficients are copied in the order used by SMLAD (two 16 bits products per instruction).
+ * The gain of a FIR filter must not exceed 1 (sum of |h| <= 32768) so that the sum stays on 32 bits.
+ * @param
+ * filter	:	Filter to initialize
+ * config	:	Type, length and coefficients
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef FLT_Init(FLT_Filter_t * filter, FLT_Config_t config)
+{
+	uint8_t taps;
+
+	memset(filter, 0, sizeof(FLT_Filter_t));
+
+	switch(config.type)
+	{
+	case FLT_NONE:
+		break;
+
+	case FLT_FIR:
+		if(config.length == 0 || config.length > FLT_FIR_MAX_TAPS || config.coefficients == NULL)
+		{
+			return HAL_ERROR;
+		}
+
+		//h[0] is applied to the newest sample, at the end of the window
+		taps = (config.length + 1) & ~1;
+		for(uint8_t k = 0; k < config.length; k++)
+		{
+			filter->coefficients[taps - 1 - k] = config.coefficients[k];
+		}
+		config.length = taps;
+		break;
+
+	case FLT_IIR:
+		if(config.length == 0 || config.length > FLT_IIR_MAX_SECTIONS || config.coefficients == NULL)
+		{
+			return HAL_ERROR;
+		}
+
+		for(uint8_t s = 0; s < config.length; s++)
+		{
+			const int16_t * c = &config.coefficients[s * FLT_IIR_COEFFICIENTS];
+			int16_t * stored = &filter->coefficients[s * FLT_IIR_STRIDE];
+
+			stored[0] = c[0];
+			stored[1] = c[1];
+			stored[2] = c[2];
+			stored[3] = -c[3];
+			stored[4] = -c[4];
+			stored[5] = 0;
+		}
+		break;
+
+	case FLT_MEDIAN:
+		if(config.length == 0 || config.length > FLT_MEDIAN_MAX || !(config.length & 1))
+		{
+			return HAL_ERROR;
+		}
+		break;
+
+	default:
+		return HAL_ERROR;
+	}
+
+	filter->type = config.type;
+	filter->length = config.length;
+
+	return HAL_OK;
+}
+
+/*
+ * FLT_Reset
+ * @brief
+ * Forget the past samples, the state is filled with the next sample
+ * @param
+ * filter	:	Filter to reset
+ * @return
+ * none
+ */
+void FLT_Reset(FLT_Filter_t * filter)
+{
+	filter->primed = 0;
+}
+
+/*
+ * FLT_Process
+ * @brief
+ * Filter a block of samples in place.
+ * The samples of one channel are read and written every stride samples (interleaved scans).
+ * @param
+ * filter	:	Filter of the channel
+ * samples	:	First sample of the channel
+ * count	:	Number of samples of the channel
+ * stride	:	Distance between two samples of the channel (number of channels)
+ * @return
+ * none
+ */
+void FLT_Process(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride)
+{
+	uint16_t length;
+
+	if(filter == NULL || filter->type == FLT_NONE || count == 0)
+	{
+		return;
+	}
+
+	if(!filter->primed)
+	{
+		FLT_Prime(filter, samples[0]);
+	}
+
+	while(count)
+	{
+		length = count > FLT_BLOCK_MAX ? FLT_BLOCK_MAX : count;
+
+		switch(filter->type)
+		{
+		case FLT_FIR:
+			FLT_Fir(filter, samples, length, stride);
+			break;
+		case FLT_IIR:
+			FLT_Iir(filter, samples, length, stride);
+			break;
+		case FLT_MEDIAN:
+			FLT_Median(filter, samples, length, stride);
+			break;
+		default:
+			break;
+		}
+
+		samples += length * stride;
+		count -= length;
+	}
+}
+
+/*
+ * FLT_Prime
+ * @brief
+ * Fill the state of a filter as if the signal had always been at its first value
+ * @param
+ * filter	:	Filter
+ * sample	:	First sample
+ * @return
+ * none
+ */
+void FLT_Prime(FLT_Filter_t * filter, int16_t sample)
+{
+	for(uint8_t k = 0; k < FLT_FIR_MAX_TAPS; k++)
+	{
+		filter->history[k] = sample;
+	}
+	for(uint8_t k = 0; k < FLT_MEDIAN_MAX; k++)
+	{
+		filter->sorted[k] = sample;
+	}
+
+	filter->position = 0;
+	filter->primed = 1;
+}
+
+/*
+ * FLT_Fir
+ * @brief
+ * FIR filter, two taps per SMLAD.
+ * The last inputs and the block are gathered in a work buffer, so that each output
+ * is the dot product of the coefficients and a contiguous window.
+ * @param
+ * filter	:	Filter
+ * samples	:	First sample
+ * count	:	Number of samples, up to FLT_BLOCK_MAX
+ * stride	:	Distance between two samples
+ * @return
+ * none
+ */
+void FLT_Fir(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride)
+{
+	uint8_t taps = filter->length;
+	int32_t acc;
+
+	memcpy(FLT_Work, filter->history, (taps - 1) * sizeof(int16_t));
+	for(uint16_t i = 0; i < count; i++)
+	{
+		FLT_Work[taps - 1 + i] = samples[i * stride];
+	}
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		acc = 0;
+		for(uint8_t k = 0; k < taps; k += 2)
+		{
+			acc = __SMLAD(FLT_Pair(&FLT_Work[i + k]), FLT_Pair(&filter->coefficients[k]), acc);
+		}
+
+		samples[i * stride] = __USAT((acc + (1 << 14)) >> 15, 16);
+	}
+
+	memcpy(filter->history, &FLT_Work[count], (taps - 1) * sizeof(int16_t));
+}
+
+/*
+ * FLT_Iir
+ * @brief
+ * Cascade of biquads in direct form I, five products in three SMLAD per section
+ * @param
+ * filter	:	Filter
+ * samples	:	First sample
+ * count	:	Number of samples
+ * stride	:	Distance between two samples
+ * @return
+ * none
+ */
+void FLT_Iir(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride)
+{
+	int16_t * state;
+	int16_t * c;
+	int32_t acc;
+	int16_t x;
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		x = samples[i * stride];
+
+		for(uint8_t s = 0; s < filter->length; s++)
+		{
+			state = &filter->history[s * FLT_IIR_STATE];
+			c = &filter->coefficients[s * FLT_IIR_STRIDE];
+
+			acc = __SMLAD(__PKHBT(x, state[0], 16), FLT_Pair(&c[0]), 0);
+			acc = __SMLAD(__PKHBT(state[1], state[2], 16), FLT_Pair(&c[2]), acc);
+			acc = __SMLAD((uint16_t)state[3], FLT_Pair(&c[4]), acc);
+
+			state[1] = state[0];
+			state[0] = x;
+			state[3] = state[2];
+			state[2] = __SSAT((acc + (1 << 13)) >> 14, 16);
+
+			x = state[2];
+		}
+
+		samples[i * stride] = x < 0 ? 0 : x;
+	}
+}
+
+/*
+ * FLT_Median
+ * @brief
+ * Moving median, the window is kept sorted : one removal and one insertion per sample
+ * @param
+ * filter	:	Filter
+ * samples	:	First sample
+ * count	:	Number of samples
+ * stride	:	Distance between two samples
+ * @return
+ * none
+ */
+void FLT_Median(FLT_Filter_t * filter, uint16_t * samples, uint16_t count, uint8_t stride)
+{
+	uint8_t size = filter->length;
+	int16_t * sorted = filter->sorted;
+	int16_t x, old;
+	uint8_t j;
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		x = samples[i * stride];
+		old = filter->history[filter->position];
+		filter->history[filter->position] = x;
+		filter->position = (filter->position + 1) % size;
+
+		//Remove the oldest sample
+		for(j = 0; j < size - 1 && sorted[j] != old; j++);
+		for(; j < size - 1; j++)
+		{
+			sorted[j] = sorted[j + 1];
+		}
+
+		//Insert the new one
+		for(j = size - 1; j > 0 && sorted[j - 1] > x; j--)
+		{
+			sorted[j] = sorted[j - 1];
+		}
+		sorted[j] = x;
+
+		samples[i * stride] = sorted[size / 2];
+	}
+}
+
+/*
+ * FLT_Pair
+ * @brief
+ * Read two 16 bits values as one 32 bits word for SMLAD (unaligned access allowed on the Cortex-M4)
+ * @param
+ * data	:	First value, in the lower half
+ * @return
+ * uint32_t : Packed values
+ */
+uint32_t FLT_Pair(const int16_t * data)
+{
+	uint32_t pair;
+
+	memcpy(&pair, data, sizeof(pair));
+
+	return pair;
+}
+
+#ifdef STO_HOST
+/*
+ * FLT_Smlad
+ * @brief
+ * SMLAD of the builds on a Linux host (-DSTO_HOST) : sum of the products of the lower halves
+ * and of the upper halves, added to an accumulator
+ * @param
+ * x	:	Two signed 16 bits values
+ * y	:	Two signed 16 bits values
+ * sum	:	Accumulator
+ * @return
+ * int32_t : sum + x[15:0] * y[15:0] + x[31:16] * y[31:16]
+ */
+int32_t FLT_Smlad(uint32_t x, uint32_t y, int32_t sum)
+{
+	return sum + (int16_t)x * (int16_t)y + (int16_t)(x >> 16) * (int16_t)(y >> 16);
+}
+#endif
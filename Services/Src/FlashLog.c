@@ -0,0 +1,538 @@
+/*
+ * FlashLog.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "FlashLog.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define FLOG_CHECK_SIZE			64			// Chunk buffer of the check of an erased sector
+#define FLOG_PROCESS_BUDGET		32			// Operations started by one call of FLOG_Process at most
+#define FLOG_TIMEOUT_PROGRAM	5			// Longest program of a record or a header (ms)
+#define FLOG_TIMEOUT_FLUSH		1000		// Longest flush : erase of a sector and programs of the queue (ms)
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+uint8_t FLOG_Erased;					// Result of the check of FLOG_isErased
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef FLOG_Operate(FLOG_Log_t * log);
+HAL_StatusTypeDef FLOG_Wait(FLOG_Log_t * log);
+uint32_t FLOG_Next(FLOG_Log_t * log, uint32_t sector, uint32_t count);
+uint32_t FLOG_Opening(FLOG_Log_t * log);
+uint8_t FLOG_isErased(FLOG_Log_t * log, uint32_t sector);
+uint8_t FLOG_ErasedChunk(uint8_t * data, uint16_t length);
+
+
+/***************************************************************************************/
+/*
+ * FLOG_Init
+ * @brief
+ * Find the head of a log from the headers of its sectors : the sector with the highest sequence,
+ * then its first empty record. The sectors already erased in front of it are counted, the other
+ * ones will be erased by FLOG_Process.
+ * @param
+ * log		:	Log to initialize
+ * device	:	Storage device, erased by sectors
+ * start	:	First address of the log (sector aligned)
+ * size		:	Size of the log (multiple of the sector)
+ * length	:	Size of one record, starting with its timestamp (4 to FLOG_RECORD_MAX Bytes)
+ * queue	:	Buffer of the records waiting to be programmed
+ * capacity	:	Size of the queue in records
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef FLOG_Init(FLOG_Log_t * log, const STO_Device_t * device, uint32_t start, uint32_t size, uint16_t length, uint8_t * queue, uint16_t capacity)
+{
+	FLOG_Sector_t header;
+	uint32_t timestamp, sector;
+
+	log->device = device;
+	log->start = start;
+	log->size = size;
+	log->length = length;
+	log->sector = FLOG_EMPTY;
+	log->head = FLOG_EMPTY;
+	log->sequence = 0;
+	log->ready = 0;
+	log->queue = queue;
+	log->capacity = capacity;
+	log->first = 0;
+	log->count = 0;
+	log->dropped = 0;
+
+	if(device == NULL || device->sector == STO_NO_ERASE || queue == NULL || capacity == 0
+		|| length < sizeof(uint32_t) || length > FLOG_RECORD_MAX
+		|| start % device->sector || size % device->sector || size / device->sector < FLOG_ERASE_AHEAD + 2
+		|| start >= device->size || size > device->size - start)
+	{
+		log->device = NULL;
+		return HAL_ERROR;
+	}
+
+	//Newest sector
+	for(sector = start; sector < start + size; sector += device->sector)
+	{
+		if(STO_Read(device, sector, (uint8_t *)&header, FLOG_HEADER_SIZE) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+		if(header.magic == FLOG_MAGIC && header.sequence != FLOG_EMPTY && (log->sector == FLOG_EMPTY || header.sequence > log->sequence))
+		{
+			log->sector = sector;
+			log->sequence = header.sequence;
+		}
+	}
+
+	//First empty record of this sector
+	if(log->sector != FLOG_EMPTY)
+	{
+		log->head = log->sector + FLOG_HEADER_SIZE;
+		while(log->head + length <= log->sector + device->sector)
+		{
+			if(STO_Read(device, log->head, (uint8_t *)&timestamp, sizeof(timestamp)) != HAL_OK)
+			{
+				return HAL_ERROR;
+			}
+			if(timestamp == FLOG_EMPTY)
+			{
+				break;
+			}
+			log->head += length;
+		}
+	}
+
+	//Sectors already erased in front of the head
+	while(log->ready < FLOG_ERASE_AHEAD && FLOG_isErased(log, FLOG_Next(log, FLOG_Opening(log), log->ready)))
+	{
+		log->ready++;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * FLOG_Append
+ * @brief
+ * Queue a record, it is programmed later by FLOG_Process. The device is not accessed,
+ * so the function never waits for a program or an erase.
+ * @param
+ * log		:	Log
+ * record	:	Record to be stored (length Bytes), starting with its timestamp
+ * @return
+ * HAL_StatusTypeDef : Status of the queue
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY		queue full, the record is dropped
+ */
+HAL_StatusTypeDef FLOG_Append(FLOG_Log_t * log, uint8_t * record)
+{
+	if(log->device == NULL)
+	{
+		return HAL_ERROR;
+	}
+	if(log->count == log->capacity)
+	{
+		log->dropped++;
+		return HAL_BUSY;
+	}
+
+	memcpy(&log->queue[((log->first + log->count) % log->capacity) * log->length], record, log->length);
+	log->count++;
+
+	return HAL_OK;
+}
+
+/*
+ * FLOG_Process
+ * @brief
+ * Drain the queue of the log when the device is free, called from the main loop : up to
+ * FLOG_PROCESS_BUDGET operations (see FLOG_Operate) are started one after the other.
+ * The end of a program is waited for, an erase ends the call and runs up to the next one.
+ * @param
+ * log : Log
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef FLOG_Process(FLOG_Log_t * log)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint8_t ready;
+
+	if(log->device == NULL || STO_isBusy(log->device))
+	{
+		return HAL_OK;
+	}
+
+	for(uint16_t k = 0; k < FLOG_PROCESS_BUDGET && state == HAL_OK; k++)
+	{
+		//Nothing queued and all the sectors in front of the head erased
+		if(!log->count && log->ready >= FLOG_ERASE_AHEAD)
+		{
+			break;
+		}
+
+		if(k)
+		{
+			state = FLOG_Wait(log);
+			if(state != HAL_OK)
+			{
+				break;
+			}
+		}
+
+		ready = log->ready;
+		state = FLOG_Operate(log);
+
+		//An erase was started
+		if(log->ready > ready)
+		{
+			break;
+		}
+	}
+
+	return state;
+}
+
+/*
+ * FLOG_Operate
+ * @brief
+ * Start one operation of the log, the device being free :
+ * - program the oldest queued record at the head
+ * - or open the next sector, already erased, with its header
+ * - or erase the next sector in front of the head, up to FLOG_ERASE_AHEAD of them.
+ * The oldest sector of the log is erased when the head comes back to it.
+ * If a program fails, the record stays queued and the head does not move : the same Bytes are
+ * programmed again by the next call (programming the same value twice leaves it unchanged).
+ * @param
+ * log : Log
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef FLOG_Operate(FLOG_Log_t * log)
+{
+	HAL_StatusTypeDef state;
+	FLOG_Sector_t header;
+	uint32_t sector;
+
+	if(log->count)
+	{
+		//Record at the head
+		if(log->sector != FLOG_EMPTY && log->head + log->length <= log->sector + log->device->sector)
+		{
+			state = STO_Program(log->device, log->head, &log->queue[log->first * log->length], log->length);
+			if(state == HAL_OK)
+			{
+				log->head += log->length;
+				log->first = (log->first + 1) % log->capacity;
+				log->count--;
+			}
+			return state;
+		}
+
+		//Next sector, if its erase is over
+		if(log->ready)
+		{
+			header.magic = FLOG_MAGIC;
+			header.sequence = log->sequence + 1;
+
+			sector = FLOG_Opening(log);
+			state = STO_Program(log->device, sector, (uint8_t *)&header, FLOG_HEADER_SIZE);
+			if(state == HAL_OK)
+			{
+				log->sector = sector;
+				log->head = sector + FLOG_HEADER_SIZE;
+				log->sequence = header.sequence;
+				log->ready--;
+			}
+			return state;
+		}
+	}
+
+	if(log->ready < FLOG_ERASE_AHEAD)
+	{
+		state = STO_Erase(log->device, FLOG_Next(log, FLOG_Opening(log), log->ready));
+		if(state == HAL_OK)
+		{
+			log->ready++;
+		}
+		return state;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * FLOG_Flush
+ * @brief
+ * Program all the queued records now, waiting for the device and erasing a sector if needed.
+ * The flush gives up after FLOG_TIMEOUT_FLUSH, the records left stay queued.
+ * @param
+ * log : Log
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef FLOG_Flush(FLOG_Log_t * log)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint32_t tickstart = HAL_GetTick();
+
+	if(log->device == NULL)
+	{
+		return HAL_ERROR;
+	}
+
+	while(log->count && state == HAL_OK)
+	{
+		if(HAL_GetTick() - tickstart > FLOG_TIMEOUT_FLUSH)
+		{
+			return HAL_TIMEOUT;
+		}
+		state = FLOG_Process(log);
+	}
+
+	return state;
+}
+
+/*
+ * FLOG_Export
+ * @brief
+ * Read the records of the log from the oldest to the newest one.
+ * The records still in the queue are not read.
+ * @param
+ * log		:	Log
+ * visitor	:	Function called for each record
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef FLOG_Export(FLOG_Log_t * log, FLOG_Visitor_t visitor)
+{
+	FLOG_Sector_t header;
+	uint8_t record[FLOG_RECORD_MAX];
+	uint32_t sectors, sector, addr, timestamp;
+
+	if(log->device == NULL)
+	{
+		return HAL_ERROR;
+	}
+	if(log->sector == FLOG_EMPTY)
+	{
+		return HAL_OK;
+	}
+
+	//The oldest sector follows the erased ones, the newest one is the sector of the head
+	sectors = log->size / log->device->sector;
+	sector = FLOG_Next(log, FLOG_Opening(log), log->ready);
+	for(uint32_t k = 0; k < sectors; k++, sector = FLOG_Next(log, sector, 1))
+	{
+		if(STO_Read(log->device, sector, (uint8_t *)&header, FLOG_HEADER_SIZE) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+		if(header.magic != FLOG_MAGIC || header.sequence > log->sequence)
+		{
+			continue;
+		}
+
+		for(addr = sector + FLOG_HEADER_SIZE; addr + log->length <= sector + log->device->sector; addr += log->length)
+		{
+			if(STO_Read(log->device, addr, record, log->length) != HAL_OK)
+			{
+				return HAL_ERROR;
+			}
+			memcpy(&timestamp, record, sizeof(timestamp));
+			if(timestamp == FLOG_EMPTY)
+			{
+				break;
+			}
+			visitor(record);
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * FLOG_getNewest
+ * @brief
+ * Get the newest record of the log, the last one queued or else the one before the head
+ * @param
+ * log		:	Log
+ * record	:	Newest record (length Bytes), its timestamp is FLOG_EMPTY if the log is empty
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef FLOG_getNewest(FLOG_Log_t * log, uint8_t * record)
+{
+	FLOG_Sector_t header;
+	uint32_t previous;
+
+	if(log->device == NULL)
+	{
+		return HAL_ERROR;
+	}
+
+	memset(record, 0xFF, log->length);
+
+	if(log->count)
+	{
+		memcpy(record, &log->queue[((log->first + log->count - 1) % log->capacity) * log->length], log->length);
+		return HAL_OK;
+	}
+	if(log->sector == FLOG_EMPTY)
+	{
+		return HAL_OK;
+	}
+	if(log->head > log->sector + FLOG_HEADER_SIZE)
+	{
+		return STO_Read(log->device, log->head - log->length, record, log->length);
+	}
+
+	//Sector of the head still empty : last record of the previous sector, left only when full
+	previous = FLOG_Next(log, log->sector, log->size / log->device->sector - 1);
+	if(STO_Read(log->device, previous, (uint8_t *)&header, FLOG_HEADER_SIZE) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	if(header.magic != FLOG_MAGIC || header.sequence + 1 != log->sequence)
+	{
+		return HAL_OK;
+	}
+
+	return STO_Read(log->device, previous + FLOG_HEADER_SIZE + (FLOG_RECORDS_PER_SECTOR(log) - 1) * log->length, record, log->length);
+}
+
+/*
+ * FLOG_Wait
+ * @brief
+ * Wait for the end of the program started by FLOG_Operate
+ * @param
+ * log : Log
+ * @return
+ * HAL_StatusTypeDef : Status of the device
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef FLOG_Wait(FLOG_Log_t * log)
+{
+	uint32_t tickstart = HAL_GetTick();
+
+	while(STO_isBusy(log->device))
+	{
+		if(HAL_GetTick() - tickstart > FLOG_TIMEOUT_PROGRAM)
+		{
+			return HAL_TIMEOUT;
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * FLOG_Next
+ * @brief
+ * Get the sector found some sectors after another one, around the log
+ * @param
+ * log		:	Log
+ * sector	:	First address of a sector
+ * count	:	Number of sectors
+ * @return
+ * uint32_t : First address of the sector
+ */
+uint32_t FLOG_Next(FLOG_Log_t * log, uint32_t sector, uint32_t count)
+{
+	return log->start + (sector - log->start + count * log->device->sector) % log->size;
+}
+
+/*
+ * FLOG_Opening
+ * @brief
+ * Get the sector the head goes to when its sector is full
+ * @param
+ * log : Log
+ * @return
+ * uint32_t : First address of the sector
+ */
+uint32_t FLOG_Opening(FLOG_Log_t * log)
+{
+	if(log->sector == FLOG_EMPTY)
+	{
+		return log->start;
+	}
+
+	return FLOG_Next(log, log->sector, 1);
+}
+
+/*
+ * FLOG_isErased
+ * @brief
+ * Check that all the Bytes of a sector read 0xFF
+ * @param
+ * log		:	Log
+ * sector	:	First address of the sector
+ * @return
+ * uint8_t : 1 if the sector is erased
+ */
+uint8_t FLOG_isErased(FLOG_Log_t * log, uint32_t sector)
+{
+	uint8_t buffer[FLOG_CHECK_SIZE];
+
+	FLOG_Erased = 1;
+	if(STO_Stream(log->device, sector, log->device->sector, buffer, sizeof(buffer), FLOG_ErasedChunk) != HAL_OK)
+	{
+		return 0;
+	}
+
+	return FLOG_Erased;
+}
+
+/*
+ * FLOG_ErasedChunk
+ * @brief
+ * Check a chunk of the sector streamed by FLOG_isErased
+ * @param
+ * data		:	Bytes read
+ * length	:	Number of Bytes
+ * @return
+ * uint8_t : 0 to stop at the first Byte programmed
+ */
+uint8_t FLOG_ErasedChunk(uint8_t * data, uint16_t length)
+{
+	for(uint16_t i = 0; i < length; i++)
+	{
+		if(data[i] != 0xFF)
+		{
+			FLOG_Erased = 0;
+			return 0;
+		}
+	}
+
+	return 1;
+}
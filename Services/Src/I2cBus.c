@@ -0,0 +1,876 @@
+/*
+ * I2cBus.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "I2cBus.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+typedef enum
+{
+	IIC_PHASE_DATA		= 0,	// Write of the register and the data, or read of the data
+	IIC_PHASE_REGISTER	= 1		// Write of the register before a read (no stop, repeated start)
+}IIC_Phase_t;
+
+#define IIC_FILTER_MIN			50			// Delay of the analog filter (ns)
+#define IIC_FILTER_MAX			260
+
+/*
+ * IIC_Spec_t definition
+ * Limits of a mode in the I2C specification (ns)
+ * speed	: Bus frequency of the mode
+ * low		: Shortest low period of SCL
+ * high		: Shortest high period of SCL
+ * setup	: Shortest data setup time
+ * valid	: Longest data valid time
+ */
+typedef struct
+{
+	IIC_Speed_t speed;
+	uint16_t low;
+	uint16_t high;
+	uint16_t setup;
+	uint16_t valid;
+} IIC_Spec_t;
+
+//Fastest mode first, for IIC_Probe
+const IIC_Spec_t IIC_Specs[] =
+{
+	{IIC_FAST_PLUS,	500,	260,	50,		450},
+	{IIC_FAST,		1300,	600,	100,	900},
+	{IIC_STANDARD,	4700,	4000,	250,	3450}
+};
+#define IIC_NB_SPECS			(sizeof(IIC_Specs) / sizeof(IIC_Spec_t))
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+DMA_HandleTypeDef IIC_hdmaTx;			// I2C1_TX -> DMA1 Channel 6
+DMA_HandleTypeDef IIC_hdmaRx;			// I2C1_RX -> DMA1 Channel 7
+
+IIC_Transfer_t * IIC_Queue[IIC_QUEUE_SIZE];
+uint8_t IIC_QueueFirst = 0;
+uint8_t IIC_QueueCount = 0;
+
+IIC_Transfer_t * volatile IIC_Active = NULL;	// Transfer on the bus
+IIC_Phase_t IIC_Phase;
+uint32_t IIC_StartTick;					// Start of the active transfer
+uint8_t IIC_Buffer[IIC_WRITE_MAX + 1];	// Register followed by the data of a write
+
+volatile uint8_t IIC_RecoverPending = 0;	// A bus error stopped the queue until the next IIC_Process
+uint32_t IIC_Recoveries = 0;
+
+IIC_Stats_t IIC_Stats[IIC_NB_DEVICES];
+uint32_t IIC_Timing[IIC_NB_DEVICES];		// TIMINGR of each device of IIC_Stats
+uint8_t IIC_NbDevices = 0;
+uint32_t IIC_DefaultTiming;				// Standard-mode TIMINGR, used for unknown devices
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void IIC_Next(void);
+HAL_StatusTypeDef IIC_Begin(IIC_Transfer_t * transfer);
+void IIC_Complete(HAL_StatusTypeDef status);
+HAL_StatusTypeDef IIC_Wait(IIC_Transfer_t * transfer);
+IIC_Stats_t * IIC_Device(uint16_t address);
+void IIC_DmaInit(DMA_HandleTypeDef * hdma, DMA_Channel_TypeDef * channel, uint32_t direction);
+void IIC_setTiming(uint32_t timing, IIC_Speed_t speed);
+
+
+/***************************************************************************************/
+/*
+ * IIC_Init
+ * @brief
+ * Initialize the transfer queue of I2C1 (configured by MX_I2C1_Init).
+ * The DMA channels and the interrupts of I2C1 are enabled, and the bus is recovered
+ * if a slave holds SDA low (reset during a read).
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef IIC_Init(void)
+{
+	//Standard-mode from the clock actually feeding I2C1, in place of the timing of MX_I2C1_Init
+	if(IIC_getTiming(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C1), IIC_STANDARD, IIC_RISE_TIME, IIC_FALL_TIME, &IIC_DefaultTiming) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	hi2c1.Init.Timing = IIC_DefaultTiming;
+	IIC_setTiming(IIC_DefaultTiming, IIC_STANDARD);
+	IIC_NbDevices = 0;
+
+	__HAL_RCC_DMA1_CLK_ENABLE();
+
+	IIC_DmaInit(&IIC_hdmaTx, DMA1_Channel6, DMA_MEMORY_TO_PERIPH);
+	IIC_DmaInit(&IIC_hdmaRx, DMA1_Channel7, DMA_PERIPH_TO_MEMORY);
+	if(HAL_DMA_Init(&IIC_hdmaTx) != HAL_OK || HAL_DMA_Init(&IIC_hdmaRx) != HAL_OK)
+	{
+		return HAL_ERROR;
+	}
+	__HAL_LINKDMA(&hi2c1, hdmatx, IIC_hdmaTx);
+	__HAL_LINKDMA(&hi2c1, hdmarx, IIC_hdmaRx);
+
+	HAL_NVIC_SetPriority(DMA1_Channel6_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel6_IRQn);
+	HAL_NVIC_SetPriority(DMA1_Channel7_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(DMA1_Channel7_IRQn);
+	HAL_NVIC_SetPriority(I2C1_EV_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+	HAL_NVIC_SetPriority(I2C1_ER_IRQn, 1, 0);
+	HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+
+	IIC_QueueFirst = 0;
+	IIC_QueueCount = 0;
+	IIC_Active = NULL;
+	IIC_RecoverPending = 0;
+
+	if(HAL_GPIO_ReadPin(IIC_SDA_PORT, IIC_SDA_PIN) == GPIO_PIN_RESET)
+	{
+		return IIC_Recover();
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * IIC_Submit
+ * @brief
+ * Queue a transfer, it starts at once if the bus is free.
+ * Reads are a write of the register then a read after a repeated start.
+ * @param
+ * transfer : Transfer to queue, it must stay valid until done is set
+ * @return
+ * HAL_StatusTypeDef : Status of the queue
+ * 					- HAL_OK
+ * 					- HAL_ERROR		invalid transfer
+ * 					- HAL_BUSY		queue full
+ */
+HAL_StatusTypeDef IIC_Submit(IIC_Transfer_t * transfer)
+{
+	if(transfer->length == 0 || (transfer->direction == IIC_WRITE && transfer->length > IIC_WRITE_MAX))
+	{
+		return HAL_ERROR;
+	}
+
+	transfer->done = 0;
+	transfer->status = HAL_BUSY;
+
+	__disable_irq();
+	if(IIC_QueueCount == IIC_QUEUE_SIZE)
+	{
+		__enable_irq();
+		return HAL_BUSY;
+	}
+	IIC_Queue[(IIC_QueueFirst + IIC_QueueCount) % IIC_QUEUE_SIZE] = transfer;
+	IIC_QueueCount++;
+	IIC_Next();
+	__enable_irq();
+
+	return HAL_OK;
+}
+
+/*
+ * IIC_Process
+ * @brief
+ * Watch the active transfer, to be called regularly (main loop, IIC_Read, IIC_Write).
+ * A transfer longer than IIC_TIMEOUT is aborted, then the bus is recovered
+ * before the queue goes on, as after a bus error.
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_Process(void)
+{
+	uint8_t recover;
+
+	__disable_irq();
+	recover = IIC_RecoverPending;
+	if(IIC_Active != NULL && HAL_GetTick() - IIC_StartTick > IIC_TIMEOUT)
+	{
+		IIC_Device(IIC_Active->address)->timeouts++;
+		HAL_DMA_Abort(&IIC_hdmaTx);
+		HAL_DMA_Abort(&IIC_hdmaRx);
+		HAL_I2C_DeInit(&hi2c1);
+
+		IIC_RecoverPending = 1;
+		IIC_Complete(HAL_TIMEOUT);
+		recover = 1;
+	}
+	__enable_irq();
+
+	if(recover)
+	{
+		IIC_Recover();
+
+		__disable_irq();
+		IIC_RecoverPending = 0;
+		IIC_Next();
+		__enable_irq();
+	}
+}
+
+/*
+ * IIC_Read
+ * @brief
+ * Read registers of a device through the queue, the core sleeps until the end of the transfer
+ * @param
+ * address	:	Address of the device, shifted as for the HAL
+ * reg		:	First register
+ * data		:	Bytes read
+ * length	:	Number of Bytes
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IIC_Read(uint16_t address, uint8_t reg, uint8_t * data, uint16_t length)
+{
+	IIC_Transfer_t transfer = {address, reg, IIC_READ, data, length, NULL, HAL_BUSY, 0};
+
+	return IIC_Wait(&transfer);
+}
+
+/*
+ * IIC_Write
+ * @brief
+ * Write registers of a device through the queue, the core sleeps until the end of the transfer
+ * @param
+ * address	:	Address of the device, shifted as for the HAL
+ * reg		:	First register
+ * data		:	Bytes to write
+ * length	:	Number of Bytes (up to IIC_WRITE_MAX)
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IIC_Write(uint16_t address, uint8_t reg, uint8_t * data, uint16_t length)
+{
+	IIC_Transfer_t transfer = {address, reg, IIC_WRITE, data, length, NULL, HAL_BUSY, 0};
+
+	return IIC_Wait(&transfer);
+}
+
+/*
+ * IIC_Recover
+ * @brief
+ * Release the bus : I2C1 is stopped and SCL is clocked by hand until the slave holding SDA
+ * lets it go (at most IIC_RECOVERY_PULSES), then a stop condition is sent and I2C1 is initialized again.
+ * Not to be called while a transfer is active (see IIC_Process).
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the recovery
+ * 					- HAL_OK
+ * 					- HAL_ERROR		SDA still low
+ */
+HAL_StatusTypeDef IIC_Recover(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	HAL_StatusTypeDef state;
+
+	HAL_I2C_DeInit(&hi2c1);
+
+	HAL_GPIO_WritePin(IIC_SCL_PORT, IIC_SCL_PIN, GPIO_PIN_SET);
+	HAL_GPIO_WritePin(IIC_SDA_PORT, IIC_SDA_PIN, GPIO_PIN_SET);
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_OD;
+	GPIO_InitStruct.Pull = GPIO_PULLUP;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Pin = IIC_SCL_PIN;
+	HAL_GPIO_Init(IIC_SCL_PORT, &GPIO_InitStruct);
+	GPIO_InitStruct.Pin = IIC_SDA_PIN;
+	HAL_GPIO_Init(IIC_SDA_PORT, &GPIO_InitStruct);
+
+	//The slave shifts out the rest of its Byte, one bit per clock
+	for(uint8_t k = 0; k < IIC_RECOVERY_PULSES && HAL_GPIO_ReadPin(IIC_SDA_PORT, IIC_SDA_PIN) == GPIO_PIN_RESET; k++)
+	{
+		HAL_GPIO_WritePin(IIC_SCL_PORT, IIC_SCL_PIN, GPIO_PIN_RESET);
+		HAL_Delay(1);
+		HAL_GPIO_WritePin(IIC_SCL_PORT, IIC_SCL_PIN, GPIO_PIN_SET);
+		HAL_Delay(1);
+	}
+	state = (HAL_GPIO_ReadPin(IIC_SDA_PORT, IIC_SDA_PIN) == GPIO_PIN_SET) ? HAL_OK : HAL_ERROR;
+
+	//Stop condition : SDA rises while SCL is high
+	HAL_GPIO_WritePin(IIC_SCL_PORT, IIC_SCL_PIN, GPIO_PIN_RESET);
+	HAL_GPIO_WritePin(IIC_SDA_PORT, IIC_SDA_PIN, GPIO_PIN_RESET);
+	HAL_Delay(1);
+	HAL_GPIO_WritePin(IIC_SCL_PORT, IIC_SCL_PIN, GPIO_PIN_SET);
+	HAL_Delay(1);
+	HAL_GPIO_WritePin(IIC_SDA_PORT, IIC_SDA_PIN, GPIO_PIN_SET);
+	HAL_Delay(1);
+
+	//HAL_I2C_MspInit gives the pins back to I2C1
+	if(HAL_I2C_Init(&hi2c1) != HAL_OK || HAL_I2CEx_ConfigAnalogFilter(&hi2c1, I2C_ANALOGFILTER_ENABLE) != HAL_OK)
+	{
+		state = HAL_ERROR;
+	}
+	IIC_Recoveries++;
+
+	return state;
+}
+
+/*
+ * IIC_getTiming
+ * @brief
+ * Compute the TIMINGR register of I2C1 for a mode, with the analog filter and without digital filter.
+ * The smallest prescaler meeting the limits of the I2C specification is kept, the bus frequency
+ * is at most the one of the mode.
+ * @param
+ * clock	:	Kernel clock of I2C1 (Hz)
+ * speed	:	Mode of the bus
+ * rise		:	Rise time of SCL and SDA (ns)
+ * fall		:	Fall time of SCL and SDA (ns)
+ * timing	:	Value of TIMINGR
+ * @return
+ * HAL_StatusTypeDef : Status of the calculation
+ * 					- HAL_OK
+ * 					- HAL_ERROR		mode out of reach of the clock
+ */
+HAL_StatusTypeDef IIC_getTiming(uint32_t clock, IIC_Speed_t speed, uint32_t rise, uint32_t fall, uint32_t * timing)
+{
+	const IIC_Spec_t * spec = NULL;
+	uint32_t cycle, sync, tick, min, max;
+	uint32_t scldel, sdadel, low, high, total;
+
+	for(uint8_t k = 0; k < IIC_NB_SPECS; k++)
+	{
+		if(IIC_Specs[k].speed == speed)
+		{
+			spec = &IIC_Specs[k];
+		}
+	}
+	if(spec == NULL || clock == 0)
+	{
+		return HAL_ERROR;
+	}
+
+	//Times in ps, the kernel clock must be fast enough to sample SCL during its low and high periods
+	cycle = 1000000000UL / (clock / 1000);
+	if(4 * cycle >= (spec->low - IIC_FILTER_MAX) * 1000UL || cycle >= spec->high * 1000UL)
+	{
+		return HAL_ERROR;
+	}
+
+	//Synchronization of SCL on each edge : slope, analog filter and 2 cycles of resynchronization
+	sync = (rise + fall + 2 * IIC_FILTER_MIN) * 1000UL + 4 * cycle;
+	if(sync >= 1000000000UL / (speed / 1000))
+	{
+		return HAL_ERROR;
+	}
+
+	for(uint32_t presc = 0; presc < 16; presc++)
+	{
+		tick = (presc + 1) * cycle;
+
+		//Data setup time after the rising edge of SDA
+		scldel = ((rise + spec->setup) * 1000UL + tick - 1) / tick;
+		scldel = (scldel > 0) ? scldel - 1 : 0;
+
+		//Data hold time, within the data valid time
+		min = (fall * 1000UL > IIC_FILTER_MIN * 1000UL + 3 * cycle) ? fall * 1000UL - IIC_FILTER_MIN * 1000UL - 3 * cycle : 0;
+		sdadel = (min + tick - 1) / tick;
+		max = spec->valid * 1000UL;
+		if(scldel > 15 || sdadel > 15 || sdadel * tick + (rise + IIC_FILTER_MAX) * 1000UL + 4 * cycle > max)
+		{
+			continue;
+		}
+
+		//Low and high periods, the sync of each edge included, then the period of the bus
+		min = IIC_FILTER_MIN * 1000UL + 2 * cycle;
+		low = (spec->low * 1000UL - min + tick - 1) / tick;
+		high = (spec->high * 1000UL > min) ? (spec->high * 1000UL - min + tick - 1) / tick : 1;
+		total = (1000000000UL / (speed / 1000) - sync + tick - 1) / tick;
+		if(total > low + high)
+		{
+			low += (total - low - high + 1) / 2;
+			high = total - low;
+		}
+		if(high == 0)
+		{
+			high = 1;
+		}
+		if(low > 256 || high > 256)
+		{
+			continue;
+		}
+
+		*timing = (presc << I2C_TIMINGR_PRESC_Pos) | (scldel << I2C_TIMINGR_SCLDEL_Pos) | (sdadel << I2C_TIMINGR_SDADEL_Pos)
+				| ((high - 1) << I2C_TIMINGR_SCLH_Pos) | ((low - 1) << I2C_TIMINGR_SCLL_Pos);
+		return HAL_OK;
+	}
+
+	return HAL_ERROR;
+}
+
+/*
+ * IIC_Probe
+ * @brief
+ * Find the fastest mode a device follows, up to the one of its datasheet : each mode the clock
+ * of I2C1 can reach is tried in turn, a device answering IIC_PROBE_READS reads of its register 0
+ * keeps it for the next transfers (see IIC_getStats).
+ * The core sleeps during the probe, to be called at startup.
+ * @param
+ * address	:	Address of the device, shifted as for the HAL
+ * speed	:	Fastest mode of the device
+ * @return
+ * HAL_StatusTypeDef : Status of the probe
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no answer, the device stays in Standard-mode
+ */
+HAL_StatusTypeDef IIC_Probe(uint16_t address, IIC_Speed_t speed)
+{
+	IIC_Stats_t * stats = IIC_Device(address);
+	uint8_t index = stats - IIC_Stats;
+	HAL_StatusTypeDef state = HAL_ERROR;
+	uint32_t timing;
+	uint8_t value;
+
+	for(uint8_t k = 0; k < IIC_NB_SPECS && state != HAL_OK; k++)
+	{
+		if(IIC_Specs[k].speed > speed
+			|| IIC_getTiming(HAL_RCCEx_GetPeriphCLKFreq(RCC_PERIPHCLK_I2C1), IIC_Specs[k].speed, IIC_RISE_TIME, IIC_FALL_TIME, &timing) != HAL_OK)
+		{
+			continue;
+		}
+
+		stats->speed = IIC_Specs[k].speed;
+		IIC_Timing[index] = timing;
+		state = HAL_OK;
+		for(uint8_t n = 0; n < IIC_PROBE_READS && state == HAL_OK; n++)
+		{
+			state = IIC_Read(address, 0x00, &value, 1);
+		}
+	}
+
+	if(state != HAL_OK)
+	{
+		stats->speed = IIC_STANDARD;
+		IIC_Timing[index] = IIC_DefaultTiming;
+	}
+
+	return state;
+}
+
+/*
+ * IIC_getStats
+ * @brief
+ * Get the statistics of a device
+ * @param
+ * address	:	Address of the device, shifted as for the HAL
+ * stats	:	Statistics of the device
+ * @return
+ * HAL_StatusTypeDef : Status of the request
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no transfer with this device yet
+ */
+HAL_StatusTypeDef IIC_getStats(uint16_t address, IIC_Stats_t * stats)
+{
+	for(uint8_t k = 0; k < IIC_NbDevices; k++)
+	{
+		if(IIC_Stats[k].address == address)
+		{
+			__disable_irq();
+			*stats = IIC_Stats[k];
+			__enable_irq();
+			return HAL_OK;
+		}
+	}
+
+	return HAL_ERROR;
+}
+
+/*
+ * IIC_getRecoveries
+ * @brief
+ * Get the number of bus recoveries since the reset
+ * @param
+ * none
+ * @return
+ * uint32_t : Number of recoveries
+ */
+uint32_t IIC_getRecoveries(void)
+{
+	return IIC_Recoveries;
+}
+
+/*
+ * IIC_EventIRQHandler
+ * @brief
+ * Handle the event interrupt of I2C1, called by I2C1_EV_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_EventIRQHandler(void)
+{
+	HAL_I2C_EV_IRQHandler(&hi2c1);
+}
+
+/*
+ * IIC_ErrorIRQHandler
+ * @brief
+ * Handle the error interrupt of I2C1, called by I2C1_ER_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_ErrorIRQHandler(void)
+{
+	HAL_I2C_ER_IRQHandler(&hi2c1);
+}
+
+/*
+ * IIC_TxIRQHandler
+ * @brief
+ * Handle the interrupt of the DMA of I2C1_TX, called by DMA1_Channel6_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_TxIRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&IIC_hdmaTx);
+}
+
+/*
+ * IIC_RxIRQHandler
+ * @brief
+ * Handle the interrupt of the DMA of I2C1_RX, called by DMA1_Channel7_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_RxIRQHandler(void)
+{
+	HAL_DMA_IRQHandler(&IIC_hdmaRx);
+}
+
+/*
+ * HAL_I2C_MasterTxCpltCallback
+ * @brief
+ * End of a write : end of the transfer, or register written before a read
+ * @param
+ * hi2c : I2C handle pointer
+ * @return
+ * none
+ */
+void HAL_I2C_MasterTxCpltCallback(I2C_HandleTypeDef * hi2c)
+{
+	IIC_Transfer_t * transfer = IIC_Active;
+	HAL_StatusTypeDef state;
+
+	if(hi2c->Instance != I2C1 || transfer == NULL)
+	{
+		return;
+	}
+
+	if(IIC_Phase == IIC_PHASE_REGISTER)
+	{
+		IIC_Phase = IIC_PHASE_DATA;
+		if(transfer->length >= IIC_DMA_MIN)
+		{
+			state = HAL_I2C_Master_Seq_Receive_DMA(&hi2c1, transfer->address, transfer->data, transfer->length, I2C_LAST_FRAME);
+		}
+		else
+		{
+			state = HAL_I2C_Master_Seq_Receive_IT(&hi2c1, transfer->address, transfer->data, transfer->length, I2C_LAST_FRAME);
+		}
+
+		if(state != HAL_OK)
+		{
+			IIC_Device(transfer->address)->errors++;
+			IIC_RecoverPending = 1;
+			IIC_Complete(HAL_ERROR);
+		}
+		return;
+	}
+
+	IIC_Complete(HAL_OK);
+}
+
+/*
+ * HAL_I2C_MasterRxCpltCallback
+ * @brief
+ * End of a read
+ * @param
+ * hi2c : I2C handle pointer
+ * @return
+ * none
+ */
+void HAL_I2C_MasterRxCpltCallback(I2C_HandleTypeDef * hi2c)
+{
+	if(hi2c->Instance == I2C1 && IIC_Active != NULL)
+	{
+		IIC_Complete(HAL_OK);
+	}
+}
+
+/*
+ * HAL_I2C_ErrorCallback
+ * @brief
+ * Error during a transfer. A NACK only ends the transfer (the HAL sends the stop),
+ * the other errors stop the queue until the bus is recovered by IIC_Process.
+ * @param
+ * hi2c : I2C handle pointer
+ * @return
+ * none
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef * hi2c)
+{
+	IIC_Stats_t * stats;
+
+	if(hi2c->Instance != I2C1 || IIC_Active == NULL)
+	{
+		return;
+	}
+
+	stats = IIC_Device(IIC_Active->address);
+	if(hi2c->ErrorCode == HAL_I2C_ERROR_AF)
+	{
+		stats->nacks++;
+	}
+	else
+	{
+		stats->errors++;
+		IIC_RecoverPending = 1;
+	}
+
+	IIC_Complete(HAL_ERROR);
+}
+
+/*
+ * IIC_Next
+ * @brief
+ * Start the next transfer of the queue if the bus is free.
+ * Called with the interrupts disabled or from the interrupts of I2C1.
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IIC_Next(void)
+{
+	if(IIC_Active != NULL || IIC_RecoverPending || IIC_QueueCount == 0)
+	{
+		return;
+	}
+
+	IIC_Active = IIC_Queue[IIC_QueueFirst];
+	IIC_QueueFirst = (IIC_QueueFirst + 1) % IIC_QUEUE_SIZE;
+	IIC_QueueCount--;
+
+	IIC_StartTick = HAL_GetTick();
+	if(IIC_Begin(IIC_Active) != HAL_OK)
+	{
+		//Bus busy or I2C1 in error
+		IIC_Device(IIC_Active->address)->errors++;
+		IIC_RecoverPending = 1;
+		IIC_Complete(HAL_ERROR);
+	}
+}
+
+/*
+ * IIC_Begin
+ * @brief
+ * Start a transfer on I2C1
+ * @param
+ * transfer : Transfer to start
+ * @return
+ * HAL_StatusTypeDef : Status of the start
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_BUSY
+ */
+HAL_StatusTypeDef IIC_Begin(IIC_Transfer_t * transfer)
+{
+	IIC_Stats_t * stats = IIC_Device(transfer->address);
+
+	IIC_setTiming(IIC_Timing[stats - IIC_Stats], stats->speed);
+
+	if(transfer->direction == IIC_READ)
+	{
+		//No stop after the register, the read follows with a repeated start
+		IIC_Phase = IIC_PHASE_REGISTER;
+		IIC_Buffer[0] = transfer->reg;
+		return HAL_I2C_Master_Seq_Transmit_IT(&hi2c1, transfer->address, IIC_Buffer, 1, I2C_FIRST_FRAME);
+	}
+
+	IIC_Phase = IIC_PHASE_DATA;
+	IIC_Buffer[0] = transfer->reg;
+	memcpy(&IIC_Buffer[1], transfer->data, transfer->length);
+	if(transfer->length + 1 >= IIC_DMA_MIN)
+	{
+		return HAL_I2C_Master_Transmit_DMA(&hi2c1, transfer->address, IIC_Buffer, transfer->length + 1);
+	}
+
+	return HAL_I2C_Master_Transmit_IT(&hi2c1, transfer->address, IIC_Buffer, transfer->length + 1);
+}
+
+/*
+ * IIC_Complete
+ * @brief
+ * End the active transfer : statistics, callback, then the next transfer
+ * @param
+ * status : Result of the transfer
+ * @return
+ * none
+ */
+void IIC_Complete(HAL_StatusTypeDef status)
+{
+	IIC_Transfer_t * transfer = IIC_Active;
+	IIC_Stats_t * stats = IIC_Device(transfer->address);
+
+	if(status == HAL_OK)
+	{
+		stats->transfers++;
+		stats->bytes += transfer->length;
+	}
+
+	IIC_Active = NULL;
+	transfer->status = status;
+	transfer->done = 1;
+	if(transfer->callback != NULL)
+	{
+		transfer->callback(transfer);
+	}
+
+	IIC_Next();
+}
+
+/*
+ * IIC_Wait
+ * @brief
+ * Queue a transfer and sleep until it is over, woken up by the interrupts or the SysTick
+ * @param
+ * transfer : Transfer to queue
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ */
+HAL_StatusTypeDef IIC_Wait(IIC_Transfer_t * transfer)
+{
+	HAL_StatusTypeDef state = IIC_Submit(transfer);
+
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	while(!transfer->done)
+	{
+		IIC_Process();
+		if(!transfer->done)
+		{
+			HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+		}
+	}
+
+	return transfer->status;
+}
+
+/*
+ * IIC_Device
+ * @brief
+ * Find the statistics of a device, a new entry is taken for an unknown address.
+ * When the table is full, the last entry is shared by the remaining devices.
+ * @param
+ * address : Address of the device
+ * @return
+ * IIC_Stats_t * : Statistics of the device
+ */
+IIC_Stats_t * IIC_Device(uint16_t address)
+{
+	for(uint8_t k = 0; k < IIC_NbDevices; k++)
+	{
+		if(IIC_Stats[k].address == address)
+		{
+			return &IIC_Stats[k];
+		}
+	}
+
+	if(IIC_NbDevices == IIC_NB_DEVICES)
+	{
+		return &IIC_Stats[IIC_NB_DEVICES - 1];
+	}
+
+	memset(&IIC_Stats[IIC_NbDevices], 0, sizeof(IIC_Stats_t));
+	IIC_Stats[IIC_NbDevices].address = address;
+	IIC_Stats[IIC_NbDevices].speed = IIC_STANDARD;
+	IIC_Timing[IIC_NbDevices] = IIC_DefaultTiming;
+
+	return &IIC_Stats[IIC_NbDevices++];
+}
+
+/*
+ * IIC_DmaInit
+ * @brief
+ * Fill the configuration of a DMA channel of I2C1 (Bytes, normal mode)
+ * @param
+ * hdma			:	DMA handle
+ * channel		:	DMA1 channel
+ * direction	:	DMA_MEMORY_TO_PERIPH or DMA_PERIPH_TO_MEMORY
+ * @return
+ * none
+ */
+void IIC_DmaInit(DMA_HandleTypeDef * hdma, DMA_Channel_TypeDef * channel, uint32_t direction)
+{
+	hdma->Instance = channel;
+	hdma->Init.Direction = direction;
+	hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+	hdma->Init.MemInc = DMA_MINC_ENABLE;
+	hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+	hdma->Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+	hdma->Init.Mode = DMA_NORMAL;
+	hdma->Init.Priority = DMA_PRIORITY_LOW;
+}
+
+/*
+ * IIC_setTiming
+ * @brief
+ * Change the timing of I2C1 between two transfers, the peripheral is disabled during the change.
+ * The Fast-mode Plus drive of the pins is enabled with this mode only.
+ * @param
+ * timing	:	Value of TIMINGR
+ * speed	:	Mode of this timing
+ * @return
+ * none
+ */
+void IIC_setTiming(uint32_t timing, IIC_Speed_t speed)
+{
+	if(hi2c1.Instance->TIMINGR == timing)
+	{
+		return;
+	}
+
+	__HAL_I2C_DISABLE(&hi2c1);
+	hi2c1.Instance->TIMINGR = timing;
+	if(speed == IIC_FAST_PLUS)
+	{
+		HAL_I2CEx_EnableFastModePlus(I2C_FASTMODEPLUS_I2C1);
+	}
+	else
+	{
+		HAL_I2CEx_DisableFastModePlus(I2C_FASTMODEPLUS_I2C1);
+	}
+	__HAL_I2C_ENABLE(&hi2c1);
+}
@@ -0,0 +1,183 @@
+/*
+ * InternalFlash.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "InternalFlash.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+extern uint8_t _slogflash[];			// Bounds of the section .logflash (see STM32F303RETX_FLASH.ld)
+extern uint8_t _elogflash[];
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+STO_Device_t IFL_Device = {0, sizeof(uint16_t), IFL_SIZE_PAGE, IFL_Read, IFL_Program, NULL, IFL_isBusy, IFL_Erase};
+FLOG_Log_t IFL_Log;
+uint8_t IFL_Queue[IFL_QUEUE_RECORDS * LOG_RECORD_SIZE];
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+
+
+/***************************************************************************************/
+/*
+ * IFL_Init
+ * @brief
+ * Initialize the overflow tier : the size of the device is given by the linker script
+ * and the head of its log is found from the headers of its pages.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_ERROR		section too small or not aligned on a page
+ */
+HAL_StatusTypeDef IFL_Init(void)
+{
+	IFL_Device.size = _elogflash - _slogflash;
+	if((uint32_t)_slogflash % IFL_SIZE_PAGE)
+	{
+		IFL_Device.size = 0;
+	}
+
+	return FLOG_Init(&IFL_Log, &IFL_Device, 0, IFL_Device.size - IFL_Device.size % IFL_SIZE_PAGE, LOG_RECORD_SIZE, IFL_Queue, IFL_QUEUE_RECORDS);
+}
+
+/*
+ * IFL_getDevice
+ * @brief
+ * Get the storage device of the overflow tier
+ * @param
+ * none
+ * @return
+ * const STO_Device_t * : Device, addressed from the start of the section .logflash
+ */
+const STO_Device_t * IFL_getDevice(void)
+{
+	return &IFL_Device;
+}
+
+/*
+ * IFL_getLog
+ * @brief
+ * Get the log of the overflow tier, to export it or to give it to LOG_setOverflow
+ * @param
+ * none
+ * @return
+ * FLOG_Log_t * : Log of the internal flash
+ */
+FLOG_Log_t * IFL_getLog(void)
+{
+	return &IFL_Log;
+}
+
+/*
+ * IFL_Read
+ * @brief
+ * Read the overflow tier, mapped in memory
+ * @param
+ * addr		:	Address of start of reading, from the start of the section
+ * data		:	Buffer of the Bytes read
+ * length	:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the read
+ * 					- HAL_OK
+ */
+HAL_StatusTypeDef IFL_Read(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	memcpy(data, &_slogflash[addr], length);
+
+	return HAL_OK;
+}
+
+/*
+ * IFL_Program
+ * @brief
+ * Program the overflow tier by half-words, the Bytes must be erased.
+ * The half-words which already hold their value are skipped : a program interrupted by an error can be done again.
+ * @param
+ * addr		:	Start address of the writing process, from the start of the section (even)
+ * data		:	Buffer of data to be written
+ * length	:	Number of Bytes to be written (even)
+ * @return
+ * HAL_StatusTypeDef : Status of the programming
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IFL_Program(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint16_t halfword;
+
+	if((addr | length) & 1)
+	{
+		return HAL_ERROR;
+	}
+
+	HAL_FLASH_Unlock();
+	for(uint16_t i = 0; i < length && state == HAL_OK; i += sizeof(uint16_t))
+	{
+		memcpy(&halfword, &data[i], sizeof(uint16_t));
+		if(memcmp(&_slogflash[addr + i], &halfword, sizeof(uint16_t)) != 0)
+		{
+			state = HAL_FLASH_Program(FLASH_TYPEPROGRAM_HALFWORD, (uint32_t)&_slogflash[addr + i], halfword);
+		}
+	}
+	HAL_FLASH_Lock();
+
+	return state;
+}
+
+/*
+ * IFL_Erase
+ * @brief
+ * Erase a page of the overflow tier
+ * @param
+ * addr : First address of the page, from the start of the section
+ * @return
+ * HAL_StatusTypeDef : Status of the erase
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IFL_Erase(uint32_t addr)
+{
+	HAL_StatusTypeDef state;
+	FLASH_EraseInitTypeDef erase;
+	uint32_t error;
+
+	erase.TypeErase = FLASH_TYPEERASE_PAGES;
+	erase.PageAddress = (uint32_t)&_slogflash[addr];
+	erase.NbPages = 1;
+
+	HAL_FLASH_Unlock();
+	state = HAL_FLASHEx_Erase(&erase, &error);
+	HAL_FLASH_Lock();
+
+	return state;
+}
+
+/*
+ * IFL_isBusy
+ * @brief
+ * Check if the flash is programming or erasing, the functions above wait for the end
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 while busy
+ */
+uint8_t IFL_isBusy(void)
+{
+	return __HAL_FLASH_GET_FLAG(FLASH_FLAG_BSY) ? 1 : 0;
+}
@@ -0,0 +1,391 @@
+/*
+ * InternalRTC.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "InternalRTC.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define IRTC_PREDIV_A			127			// 32768 Hz / 128 = 256 Hz
+#define IRTC_PREDIV_S			255			// 256 Hz / 256 = 1 Hz
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+uint32_t IRTC_LastSync = 0;
+int32_t IRTC_Drift = 0;					// Last offset measured between the DS1307 and the internal RTC (s)
+uint16_t IRTC_WakeUpPeriod = IRTC_WAKEUP_OFF;
+volatile uint8_t IRTC_WakeUpFlag = 0;
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IRTC_EnterInit(void);
+void IRTC_ExitInit(void);
+
+
+/***************************************************************************************/
+/*
+ * IRTC_Init
+ * @brief
+ * Initialize the RTC of the MCU, clocked by the LSE (32.768 kHz crystal on PC14/PC15),
+ * and set its calendar from the DS1307.
+ * The internal RTC gives the timestamps with a register read and wakes the MCU up,
+ * the DS1307 stays the battery-backed reference.
+ *
+ * The registers are accessed directly, the RTC HAL driver is not part of the project
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IRTC_Init(void)
+{
+	HAL_StatusTypeDef state;
+	RCC_OscInitTypeDef RCC_OscInitStruct = {0};
+	RCC_PeriphCLKInitTypeDef PeriphClkInit = {0};
+
+	//Access to the backup domain
+	__HAL_RCC_PWR_CLK_ENABLE();
+	HAL_PWR_EnableBkUpAccess();
+
+	//Start the LSE and select it as clock of the RTC
+	RCC_OscInitStruct.OscillatorType = RCC_OSCILLATORTYPE_LSE;
+	RCC_OscInitStruct.LSEState = RCC_LSE_ON;
+	RCC_OscInitStruct.PLL.PLLState = RCC_PLL_NONE;
+	state = HAL_RCC_OscConfig(&RCC_OscInitStruct);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	PeriphClkInit.PeriphClockSelection = RCC_PERIPHCLK_RTC;
+	PeriphClkInit.RTCClockSelection = RCC_RTCCLKSOURCE_LSE;
+	state = HAL_RCCEx_PeriphCLKConfig(&PeriphClkInit);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	__HAL_RCC_RTC_ENABLE();
+
+	//Prescalers for a 1 Hz calendar, 24H format
+	state = IRTC_EnterInit();
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	RTC->CR &= ~RTC_CR_FMT;
+	RTC->PRER = IRTC_PREDIV_S;
+	RTC->PRER |= IRTC_PREDIV_A << RTC_PRER_PREDIV_A_Pos;
+
+	IRTC_ExitInit();
+
+	return IRTC_Sync();
+}
+
+/*
+ * IRTC_getTimestamp
+ * @brief
+ * Read the date of the internal RTC, no communication is needed
+ * @param
+ * none
+ * @return
+ * uint32_t	:	Number of seconds since 01/01/2000 00:00:00
+ */
+uint32_t IRTC_getTimestamp(void)
+{
+	RTC_Date_t date;
+	uint32_t time, day;
+
+	//Reading TR locks the shadow DR until it is read
+	time = RTC->TR;
+	day = RTC->DR;
+
+	date.year = bcd2bin((day & (RTC_DR_YT | RTC_DR_YU)) >> RTC_DR_YU_Pos);
+	date.month = bcd2bin((day & (RTC_DR_MT | RTC_DR_MU)) >> RTC_DR_MU_Pos);
+	date.dateNumber = bcd2bin((day & (RTC_DR_DT | RTC_DR_DU)) >> RTC_DR_DU_Pos);
+	date.day = (day & RTC_DR_WDU) >> RTC_DR_WDU_Pos;
+	date.hour = bcd2bin((time & (RTC_TR_HT | RTC_TR_HU)) >> RTC_TR_HU_Pos);
+	date.minutes = bcd2bin((time & (RTC_TR_MNT | RTC_TR_MNU)) >> RTC_TR_MNU_Pos);
+	date.seconds = bcd2bin((time & (RTC_TR_ST | RTC_TR_SU)) >> RTC_TR_SU_Pos);
+	date.hourMode = HOUR_TYPE_24H;
+	date.timeMode = AM_PM_NONE;
+
+	return RTC_toTimestamp(&date);
+}
+
+/*
+ * IRTC_setTimestamp
+ * @brief
+ * Set the calendar of the internal RTC
+ * @param
+ * timestamp	:	Number of seconds since 01/01/2000 00:00:00
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IRTC_setTimestamp(uint32_t timestamp)
+{
+	HAL_StatusTypeDef state;
+	RTC_Date_t date;
+
+	RTC_fromTimestamp(timestamp, &date);
+
+	state = IRTC_EnterInit();
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	RTC->TR = ((uint32_t)bin2bcd(date.hour) << RTC_TR_HU_Pos) |
+			  ((uint32_t)bin2bcd(date.minutes) << RTC_TR_MNU_Pos) |
+			  ((uint32_t)bin2bcd(date.seconds) << RTC_TR_SU_Pos);
+	RTC->DR = ((uint32_t)bin2bcd(date.year) << RTC_DR_YU_Pos) |
+			  ((uint32_t)date.day << RTC_DR_WDU_Pos) |
+			  ((uint32_t)bin2bcd(date.month) << RTC_DR_MU_Pos) |
+			  ((uint32_t)bin2bcd(date.dateNumber) << RTC_DR_DU_Pos);
+
+	IRTC_ExitInit();
+
+	return HAL_OK;
+}
+
+/*
+ * IRTC_isSyncDue
+ * @brief
+ * Check if the internal RTC must be synchronized with the DS1307
+ * @param
+ * timestamp	:	Date of the internal RTC
+ * @return
+ * uint8_t	: 	0 = Not yet
+ * 				1 = IRTC_SYNC_PERIOD elapsed since the last synchronization
+ */
+uint8_t IRTC_isSyncDue(uint32_t timestamp)
+{
+	return timestamp - IRTC_LastSync >= IRTC_SYNC_PERIOD;
+}
+
+/*
+ * IRTC_Sync
+ * @brief
+ * Read the DS1307 and correct the internal RTC if they differ.
+ * The offset found is kept to follow the drift of the LSE.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IRTC_Sync(void)
+{
+	HAL_StatusTypeDef state;
+	RTC_Date_t date;
+	uint32_t reference;
+
+	state = RTC_getDate(&date);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	reference = RTC_toTimestamp(&date);
+	IRTC_Drift = (int32_t)(reference - IRTC_getTimestamp());
+	IRTC_LastSync = reference;
+
+	if(IRTC_Drift != 0)
+	{
+		state = IRTC_setTimestamp(reference);
+	}
+
+	return state;
+}
+
+/*
+ * IRTC_getDrift
+ * @brief
+ * Get the offset measured at the last synchronization
+ * @param
+ * none
+ * @return
+ * int32_t : DS1307 - internal RTC (s)
+ */
+int32_t IRTC_getDrift(void)
+{
+	return IRTC_Drift;
+}
+
+/*
+ * IRTC_setWakeUp
+ * @brief
+ * Setup the periodic wake-up timer of the internal RTC (EXTI line 20)
+ * @param
+ * period	:	Interval between two wake-ups in seconds, IRTC_WAKEUP_OFF to stop the timer
+ * @return
+ * HAL_StatusTypeDef : Status of the configuration
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IRTC_setWakeUp(uint16_t period)
+{
+	uint32_t tickstart;
+
+	RTC->WPR = 0xCA;
+	RTC->WPR = 0x53;
+
+	RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+	IRTC_WakeUpPeriod = IRTC_WAKEUP_OFF;
+
+	if(period == IRTC_WAKEUP_OFF)
+	{
+		RTC->WPR = 0xFF;
+		return HAL_OK;
+	}
+
+	tickstart = HAL_GetTick();
+	while(!(RTC->ISR & RTC_ISR_WUTWF))
+	{
+		if(HAL_GetTick() - tickstart > IRTC_TIMEOUT)
+		{
+			RTC->WPR = 0xFF;
+			return HAL_TIMEOUT;
+		}
+	}
+
+	//Clocked by ck_spre (1 Hz)
+	RTC->WUTR = period - 1;
+	RTC->CR = (RTC->CR & ~RTC_CR_WUCKSEL) | RTC_CR_WUCKSEL_2;
+	RTC->ISR = (uint32_t)~(RTC_ISR_WUTF | RTC_ISR_INIT);
+	RTC->CR |= RTC_CR_WUTIE | RTC_CR_WUTE;
+
+	RTC->WPR = 0xFF;
+
+	EXTI->PR = EXTI_PR_PR20;
+	EXTI->RTSR |= EXTI_RTSR_TR20;
+	EXTI->IMR |= EXTI_IMR_MR20;
+	HAL_NVIC_SetPriority(RTC_WKUP_IRQn, 0, 0);
+	HAL_NVIC_EnableIRQ(RTC_WKUP_IRQn);
+
+	IRTC_WakeUpPeriod = period;
+	IRTC_WakeUpFlag = 0;
+
+	return HAL_OK;
+}
+
+/*
+ * IRTC_Sleep
+ * @brief
+ * Stop the CPU until the next wake-up of the internal RTC.
+ * The SysTick is suspended so that it does not wake the CPU up every ms.
+ * Nothing is done if the wake-up timer is off.
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IRTC_Sleep(void)
+{
+	if(IRTC_WakeUpPeriod == IRTC_WAKEUP_OFF)
+	{
+		return;
+	}
+
+	HAL_SuspendTick();
+	while(!IRTC_WakeUpFlag)
+	{
+		HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
+	}
+	HAL_ResumeTick();
+
+	IRTC_WakeUpFlag = 0;
+}
+
+/*
+ * IRTC_IRQHandler
+ * @brief
+ * Handle the interrupt of the wake-up timer, called by RTC_WKUP_IRQHandler
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IRTC_IRQHandler(void)
+{
+	if(RTC->ISR & RTC_ISR_WUTF)
+	{
+		RTC->ISR = (uint32_t)~(RTC_ISR_WUTF | RTC_ISR_INIT);
+		IRTC_WakeUpFlag = 1;
+	}
+
+	EXTI->PR = EXTI_PR_PR20;
+}
+
+/*
+ * IRTC_EnterInit
+ * @brief
+ * Remove the write protection and stop the calendar to update it
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the initialization
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef IRTC_EnterInit(void)
+{
+	uint32_t tickstart;
+
+	RTC->WPR = 0xCA;
+	RTC->WPR = 0x53;
+
+	RTC->ISR |= RTC_ISR_INIT;
+
+	tickstart = HAL_GetTick();
+	while(!(RTC->ISR & RTC_ISR_INITF))
+	{
+		if(HAL_GetTick() - tickstart > IRTC_TIMEOUT)
+		{
+			RTC->ISR = (uint32_t)~(RTC_ISR_INIT);
+			RTC->WPR = 0xFF;
+			return HAL_TIMEOUT;
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * IRTC_ExitInit
+ * @brief
+ * Restart the calendar and put the write protection back.
+ * The shadow registers are resynchronized before the next read.
+ * @param
+ * none
+ * @return
+ * none
+ */
+void IRTC_ExitInit(void)
+{
+	uint32_t tickstart;
+
+	RTC->ISR = (uint32_t)~(RTC_ISR_INIT | RTC_ISR_RSF);
+	RTC->WPR = 0xFF;
+
+	tickstart = HAL_GetTick();
+	while(!(RTC->ISR & RTC_ISR_RSF) && HAL_GetTick() - tickstart <= IRTC_TIMEOUT);
+}
@@ -0,0 +1,284 @@
+/*
+ * LogIndex.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "LogIndex.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef IDX_ReadTimestamp(LOG_Ring_t * ring, uint32_t addr, uint32_t * timestamp);
+
+
+/***************************************************************************************/
+/*
+ * IDX_Build
+ * @brief
+ * Build the sparse index of a circular area and find its head.
+ * The index keeps the timestamp of the first record of each page (the records must start with their timestamp).
+ * The newest page is the one with the highest sequence number (see PAGE LAYOUT in DataLog.h), the
+ * timestamps are not used as the clock may have been set back. The pages written before the sequence
+ * numbers count as number 0, the most recent first timestamp decides between them.
+ * The head is the first empty record of the newest page, or the start of the next page if it is sealed.
+ * @param
+ * ring		:	Circular area, with its index table
+ * length	:	Size of one record
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef IDX_Build(LOG_Ring_t * ring, uint16_t length)
+{
+	HAL_StatusTypeDef state;
+	uint16_t pages = IDX_PAGES(ring->size);
+	uint16_t newest = pages;
+	uint32_t addr, end, sequence, timestamp, crc;
+
+	ring->sequence = 0;
+	ring->last = 0;
+
+	for(uint16_t page = 0; page < pages; page++)
+	{
+		addr = ring->start + page * EE_SIZE_PAGE;
+		state = IDX_ReadTimestamp(ring, addr, &ring->index[page]);
+		if(state == HAL_OK && ring->index[page] != IDX_EMPTY)
+		{
+			state = IDX_ReadTimestamp(ring, addr + LOG_PAGE_SEQUENCE, &sequence);
+		}
+		if(state != HAL_OK)
+		{
+			return state;
+		}
+
+		if(ring->index[page] == IDX_EMPTY)
+		{
+			continue;
+		}
+		if(sequence == IDX_EMPTY)
+		{
+			sequence = 0;
+		}
+
+		if(newest == pages || sequence > ring->sequence
+			|| (sequence == ring->sequence && ring->index[page] >= ring->index[newest]))
+		{
+			newest = page;
+			ring->sequence = sequence;
+		}
+	}
+
+	if(newest == pages)
+	{
+		//Empty area
+		ring->head = ring->start;
+		ring->wrapped = 0;
+		return HAL_OK;
+	}
+
+	//Look for the end of the newest page
+	addr = ring->start + newest * EE_SIZE_PAGE;
+	end = addr + LOG_RECORDS_PER_PAGE(length) * length;
+	ring->last = ring->index[newest];
+
+	for(addr += length; addr < end; addr += length)
+	{
+		state = IDX_ReadTimestamp(ring, addr, &timestamp);
+		if(state != HAL_OK)
+		{
+			return state;
+		}
+
+		if(timestamp == IDX_EMPTY)
+		{
+			break;
+		}
+		ring->last = timestamp;
+	}
+
+	//A page sealed before it is full is not written any more
+	if(addr < end)
+	{
+		state = IDX_ReadTimestamp(ring, ring->start + newest * EE_SIZE_PAGE + LOG_PAGE_DATA, &crc);
+		if(state != HAL_OK)
+		{
+			return state;
+		}
+		if(crc != LOG_UNSEALED)
+		{
+			addr = end;
+		}
+	}
+
+	if(addr >= end)
+	{
+		addr = LOG_RingNext(ring, end - length, length);
+	}
+	ring->head = addr;
+
+	//Data in the page following the newest one is left from the previous lap
+	ring->wrapped = ring->index[(newest + 1) % pages] != IDX_EMPTY && pages > 1;
+
+	return HAL_OK;
+}
+
+/*
+ * IDX_Update
+ * @brief
+ * Update the index of a circular area once a record is written.
+ * Nothing is done if the record is not the first one of its page.
+ * @param
+ * ring	:	Circular area, with its index table
+ * addr	:	Address of the record
+ * data	:	Record, starting with its timestamp
+ * @return
+ * none
+ */
+void IDX_Update(LOG_Ring_t * ring, uint32_t addr, uint8_t * data)
+{
+	uint32_t timestamp;
+
+	if(ring->index == NULL || ((addr - ring->start) % EE_SIZE_PAGE) != 0)
+	{
+		return;
+	}
+
+	memcpy(&timestamp, data, sizeof(timestamp));
+	ring->index[(addr - ring->start) / EE_SIZE_PAGE] = timestamp;
+}
+
+/*
+ * IDX_Find
+ * @brief
+ * Binary search of the index of a circular area.
+ * Only the index in RAM is read, the EEPROM is not accessed. If the clock went back,
+ * the index cannot be searched and the oldest record is given.
+ * @param
+ * ring			:	Circular area, with its index table
+ * timestamp	:	Time searched in seconds since 01/01/2000 00:00:00
+ * @return
+ * uint32_t : Address of the page which contains the first records at or after the timestamp,
+ * 			  or the address of the oldest record if the whole area is more recent
+ */
+uint32_t IDX_Find(LOG_Ring_t * ring, uint32_t timestamp)
+{
+	uint16_t pages = IDX_PAGES(ring->size);
+	uint16_t headPage = (ring->head - ring->start) / EE_SIZE_PAGE;
+	uint16_t first, count, low, high, middle;
+	int32_t found = -1;
+
+	//After a step back of the clock, the whole area is read
+	if(!IDX_isOrdered(ring))
+	{
+		return LOG_RingOldest(ring);
+	}
+
+	if(ring->wrapped)
+	{
+		//The page of the head holds the newest and the oldest records, it is not searched
+		first = (headPage + 1) % pages;
+		count = pages - 1;
+	}
+	else
+	{
+		first = 0;
+		count = (ring->head - ring->start + EE_SIZE_PAGE - 1) / EE_SIZE_PAGE;
+	}
+
+	//Last page whose first record is not after the timestamp
+	low = 0;
+	high = count;
+	while(low < high)
+	{
+		middle = (low + high) / 2;
+		if(ring->index[(first + middle) % pages] <= timestamp)
+		{
+			found = middle;
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if(found < 0)
+	{
+		return LOG_RingOldest(ring);
+	}
+
+	return ring->start + ((first + found) % pages) * EE_SIZE_PAGE;
+}
+
+/*
+ * IDX_isOrdered
+ * @brief
+ * Check that the first timestamps of the pages of a circular area follow the order of the writes.
+ * The records of a page always follow the time (see LOG_RingAlign), so the whole area does if its pages do :
+ * the index can be searched and a scan can stop after the time range. Only the index in RAM is read.
+ * @param
+ * ring : Circular area, with its index table
+ * @return
+ * uint8_t	:	0 = The clock went back
+ * 				1 = The timestamps never decrease
+ */
+uint8_t IDX_isOrdered(LOG_Ring_t * ring)
+{
+	uint16_t pages = IDX_PAGES(ring->size);
+	uint16_t page = (LOG_RingOldest(ring) - ring->start) / EE_SIZE_PAGE;
+	uint32_t previous = 0;
+
+	//The page of the head holds the newest records once they are written
+	if(ring->wrapped && (ring->head - ring->start) % EE_SIZE_PAGE)
+	{
+		page = (page + 1) % pages;
+	}
+
+	for(uint16_t k = 0; k < pages; k++)
+	{
+		if(ring->index[page] != IDX_EMPTY)
+		{
+			if(ring->index[page] < previous)
+			{
+				return 0;
+			}
+			previous = ring->index[page];
+		}
+		page = (page + 1) % pages;
+	}
+
+	return 1;
+}
+
+/*
+ * IDX_ReadTimestamp
+ * @brief
+ * Read the timestamp at the beginning of a record, or the sequence number or the CRC of a page
+ * @param
+ * ring			:	Circular area
+ * addr			:	Address of the record, or of the word of the page
+ * timestamp	:	Pointer of a variable to save the timestamp
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef IDX_ReadTimestamp(LOG_Ring_t * ring, uint32_t addr, uint32_t * timestamp)
+{
+	return STO_Read(ring->device, addr, (uint8_t *)timestamp, sizeof(uint32_t));
+}
@@ -0,0 +1,369 @@
+/*
+ * NorFlash.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "NorFlash.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define NOR_WIP					0x01		// Write In Progress bit of the status register
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+NOR_ID_t NOR_ID = {0, 0, 0};
+uint8_t NOR_AddrBytes = 3;				// 4 on the parts larger than 16 MB
+uint8_t NOR_Busy = 0;					// A program or an erase was started
+STO_Device_t NOR_Device = {0, NOR_SIZE_PAGE, NOR_SIZE_SECTOR, NOR_Read, NOR_Program, NULL, NOR_isBusy, NOR_Erase};
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef NOR_Command(uint8_t opcode, uint8_t opcode4, uint32_t addr);
+HAL_StatusTypeDef NOR_WriteEnable(void);
+HAL_StatusTypeDef NOR_Wait(uint32_t timeout);
+uint8_t NOR_ReadStatus(void);
+
+
+/***************************************************************************************/
+/*
+ * NOR_Init
+ * @brief
+ * Look for a SPI NOR flash on SPI2 : the chip select is configured, the flash is woken up
+ * from deep power-down and its JEDEC ID gives the size of the device.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the probe
+ * 					- HAL_OK
+ * 					- HAL_ERROR		no flash, or capacity not supported
+ */
+HAL_StatusTypeDef NOR_Init(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+	uint8_t cmd = NOR_RES;
+	uint8_t id[3];
+
+	HAL_GPIO_WritePin(NOR_CS_PORT, NOR_CS_PIN, GPIO_PIN_SET);
+	GPIO_InitStruct.Pin = NOR_CS_PIN;
+	GPIO_InitStruct.Mode = GPIO_MODE_OUTPUT_PP;
+	GPIO_InitStruct.Pull = GPIO_NOPULL;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+	HAL_GPIO_Init(NOR_CS_PORT, &GPIO_InitStruct);
+
+	EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+	HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+	EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+	HAL_Delay(1);
+
+	cmd = NOR_RDID;
+	EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+	HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+	HAL_SPI_Receive(&hspi2, id, 3, HAL_MAX_DELAY);
+	EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+
+	NOR_ID.manufacturer = id[0];
+	NOR_ID.type = id[1];
+	NOR_ID.capacity = id[2];
+	NOR_Device.size = 0;
+
+	//Nothing answers : MISO stays at 0x00 or 0xFF
+	if(id[0] == 0x00 || id[0] == 0xFF || id[2] < NOR_CAPACITY_MIN || id[2] > NOR_CAPACITY_MAX)
+	{
+		return HAL_ERROR;
+	}
+
+	NOR_Device.size = 1UL << id[2];
+	NOR_AddrBytes = (NOR_Device.size > NOR_SIZE_3BYTES) ? 4 : 3;
+	NOR_Busy = 1;
+
+	return NOR_Wait(NOR_TIMEOUT_ERASE);
+}
+
+/*
+ * NOR_getID
+ * @brief
+ * Get the JEDEC ID read by NOR_Init
+ * @param
+ * id : JEDEC ID of the flash
+ * @return
+ * none
+ */
+void NOR_getID(NOR_ID_t * id)
+{
+	*id = NOR_ID;
+}
+
+/*
+ * NOR_getDevice
+ * @brief
+ * Get the storage device of the flash
+ * @param
+ * none
+ * @return
+ * const STO_Device_t * : Device, NULL if NOR_Init did not find a flash
+ */
+const STO_Device_t * NOR_getDevice(void)
+{
+	if(NOR_Device.size == 0)
+	{
+		return NULL;
+	}
+
+	return &NOR_Device;
+}
+
+/*
+ * NOR_Read
+ * @brief
+ * Read the flash, after the end of the program or erase in progress
+ * @param
+ * addr		:	Address of start of reading
+ * data		:	Buffer of the Bytes read
+ * length	:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef NOR_Read(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state;
+
+	state = NOR_Wait(NOR_TIMEOUT_ERASE);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+	state = NOR_Command(NOR_READ, NOR_READ4, addr);
+	if(state == HAL_OK)
+	{
+		state = HAL_SPI_Receive(&hspi2, data, length, HAL_MAX_DELAY);
+	}
+	EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+
+	return state;
+}
+
+/*
+ * NOR_Program
+ * @brief
+ * Program Bytes already erased, one Page Program per page of the flash.
+ * The function returns while the last page is being programmed (see NOR_isBusy).
+ * @param
+ * addr		:	Start address of the writing process
+ * data		:	Buffer of data to be written, free again at the return of the function
+ * length	:	Number of Bytes to be written
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef NOR_Program(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint16_t part;
+
+	while(length && state == HAL_OK)
+	{
+		part = NOR_SIZE_PAGE - (addr % NOR_SIZE_PAGE);
+		if(part > length)
+		{
+			part = length;
+		}
+
+		state = NOR_Wait(NOR_TIMEOUT_ERASE);
+		if(state == HAL_OK)
+		{
+			state = NOR_WriteEnable();
+		}
+		if(state == HAL_OK)
+		{
+			EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+			state = NOR_Command(NOR_PP, NOR_PP4, addr);
+			if(state == HAL_OK)
+			{
+				state = HAL_SPI_Transmit(&hspi2, data, part, HAL_MAX_DELAY);
+			}
+			EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+			NOR_Busy = 1;
+		}
+
+		addr += part;
+		data += part;
+		length -= part;
+	}
+
+	return state;
+}
+
+/*
+ * NOR_Erase
+ * @brief
+ * Start the erase of a sector of 4 KB and return at once, the erase goes on for tens of ms.
+ * NOR_isBusy tells when it is over, the next access waits for it.
+ * @param
+ * addr : Address in the sector
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef NOR_Erase(uint32_t addr)
+{
+	HAL_StatusTypeDef state;
+
+	state = NOR_Wait(NOR_TIMEOUT_ERASE);
+	if(state == HAL_OK)
+	{
+		state = NOR_WriteEnable();
+	}
+	if(state == HAL_OK)
+	{
+		EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+		state = NOR_Command(NOR_SE, NOR_SE4, addr - addr % NOR_SIZE_SECTOR);
+		EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+		NOR_Busy = 1;
+	}
+
+	return state;
+}
+
+/*
+ * NOR_isBusy
+ * @brief
+ * Check without waiting if a program or an erase is in progress
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 while the flash is busy
+ */
+uint8_t NOR_isBusy(void)
+{
+	if(NOR_Busy && !(NOR_ReadStatus() & NOR_WIP))
+	{
+		NOR_Busy = 0;
+	}
+
+	return NOR_Busy;
+}
+
+/*
+ * NOR_Command
+ * @brief
+ * Send an opcode followed by an address, CS stays low for the data
+ * @param
+ * opcode	:	Opcode of the parts addressed with 3 Bytes
+ * opcode4	:	Opcode of the parts addressed with 4 Bytes
+ * addr		:	Address
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef NOR_Command(uint8_t opcode, uint8_t opcode4, uint32_t addr)
+{
+	uint8_t cmd[5];
+
+	if(NOR_AddrBytes == 4)
+	{
+		cmd[0] = opcode4;
+		cmd[1] = (addr >> 24) & 0xFF;
+		cmd[2] = (addr >> 16) & 0xFF;
+		cmd[3] = (addr >> 8) & 0xFF;
+		cmd[4] = addr & 0xFF;
+	}
+	else
+	{
+		cmd[0] = opcode;
+		cmd[1] = (addr >> 16) & 0xFF;
+		cmd[2] = (addr >> 8) & 0xFF;
+		cmd[3] = addr & 0xFF;
+	}
+
+	return HAL_SPI_Transmit(&hspi2, cmd, NOR_AddrBytes + 1, HAL_MAX_DELAY);
+}
+
+/*
+ * NOR_WriteEnable
+ * @brief
+ * Set the write enable latch before a program or an erase
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef NOR_WriteEnable(void)
+{
+	HAL_StatusTypeDef state;
+	uint8_t cmd = NOR_WREN;
+
+	EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+	state = HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+	EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+
+	return state;
+}
+
+/*
+ * NOR_Wait
+ * @brief
+ * Wait for the end of the program or erase in progress
+ * @param
+ * timeout : Longest wait (ms)
+ * @return
+ * HAL_StatusTypeDef : Status of the flash
+ * 					- HAL_OK
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef NOR_Wait(uint32_t timeout)
+{
+	uint32_t tickstart = HAL_GetTick();
+
+	while(NOR_isBusy())
+	{
+		if(HAL_GetTick() - tickstart > timeout)
+		{
+			return HAL_TIMEOUT;
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * NOR_ReadStatus
+ * @brief
+ * Read the status register 1 of the flash
+ * @param
+ * none
+ * @return
+ * uint8_t : Status register (NOR_WIP)
+ */
+uint8_t NOR_ReadStatus(void)
+{
+	uint8_t cmd = NOR_RDSR;
+	uint8_t status = 0;
+
+	EE_Select(NOR_CS_PORT, NOR_CS_PIN);
+	HAL_SPI_Transmit(&hspi2, &cmd, 1, HAL_MAX_DELAY);
+	HAL_SPI_Receive(&hspi2, &status, 1, HAL_MAX_DELAY);
+	EE_Deselect(NOR_CS_PORT, NOR_CS_PIN);
+
+	return status;
+}
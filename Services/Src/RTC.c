@@ -23,8 +23,9 @@
 /*
  * PRIVATE FUNCTION PROTOTYPES
  */
-uint8_t bcd2bin(uint8_t value);
-uint8_t bin2bcd(uint8_t value);
+uint8_t RTC_isLeapYear(uint8_t year);
+uint8_t RTC_isDateValid(RTC_Date_t * RTC_Date);
+void RTC_decodeHour(uint8_t reg, uint8_t * hour, uint8_t * hourMode, TIME_12H_t * time);
 
 
 /***************************************************************************************/
@@ -32,8 +33,11 @@ uint8_t bin2bcd(uint8_t value);
  * RTC_Init
  * @brief
  * Initialize the RTC module
+ * The date kept by the battery is left as it is. The given date is written only if the RTC
+ * lost the time : oscillator stopped (CH bit of the seconds register) or date out of range.
+ * Use RTC_setDate to change the date on purpose.
  * @param
- * RTC_Date		:	Structure of RTC date
+ * RTC_Date		:	Date written if the RTC lost the time
  * squareWave	:	Shape of the SWQ/OUT pin of the RTC
  * @return
  * HAL_StatusTypeDef : Status of the communication
@@ -43,23 +47,42 @@ uint8_t bin2bcd(uint8_t value);
 HAL_StatusTypeDef RTC_Init(RTC_Date_t RTC_Date, SQW_t squareWave)
 {
 	HAL_StatusTypeDef state;
+	RTC_Date_t current;
 	uint8_t buf[2];
+	uint8_t lost;
 
 	buf[0] = 0x00;
 
+	//Clock halted since the loss of the supply
+	state = IIC_Read(RTC_addr, buf[0], &buf[1], 1);
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+	lost = (buf[1] & 0x80) != 0;
+
+	if(!lost)
+	{
+		lost = RTC_getDate(&current) != HAL_OK || !RTC_isDateValid(&current);
+	}
+
 	//Enable Clock
- 	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, &buf[0], 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, &buf[1], 1, HAL_MAX_DELAY);
-	buf[1] &= 0x7F;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	if(buf[1] & 0x80)
+	{
+		buf[1] &= 0x7F;
+		state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
+	}
 
 	//Setup the squarewave output
 	buf[0] = 0x07;
 	buf[1] = (uint8_t)squareWave;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 
 	//Setup the RTC date
-	RTC_setDate(RTC_Date);
+	if(lost && state == HAL_OK)
+	{
+		state = RTC_setDate(RTC_Date);
+	}
 
 	return state;
 }
@@ -114,25 +137,43 @@ HAL_StatusTypeDef RTC_changeHourMode(void)
 /***************************************************************************************/
 /************************************** GETTERS ****************************************/
 /***************************************************************************************/
+/*
+ * RTC_getDate
+ * @brief
+ * Read the date in a single transfer of the 7 time registers,
+ * the DS1307 latches them at the start so the fields are consistent
+ * @param
+ * RTC_Date	:	Date read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
 HAL_StatusTypeDef RTC_getDate(RTC_Date_t * RTC_Date)
 {
 	HAL_StatusTypeDef state;
-	state = RTC_getSeconds(&RTC_Date->seconds);
-	state = RTC_getMinutes(&RTC_Date->minutes);
-	state = RTC_getHour(&RTC_Date->hour, &RTC_Date->hourMode, &RTC_Date->timeMode);
-	state = RTC_getDay(&RTC_Date->day);
-	state = RCT_getDateNumber(&RTC_Date->dateNumber);
-	state = RTC_getMonth(&RTC_Date->month);
-	state = RTC_getYear(&RTC_Date->year);
+	uint8_t buf[7];
+
+	state = IIC_Read(RTC_addr, 0x00, buf, sizeof(buf));
+	if(state != HAL_OK)
+	{
+		return state;
+	}
+
+	RTC_Date->seconds = bcd2bin(buf[0]);
+	RTC_Date->minutes = bcd2bin(buf[1]);
+	RTC_decodeHour(buf[2], &RTC_Date->hour, &RTC_Date->hourMode, &RTC_Date->timeMode);
+	RTC_Date->day = buf[3];
+	RTC_Date->dateNumber = bcd2bin(buf[4]);
+	RTC_Date->month = bcd2bin(buf[5]);
+	RTC_Date->year = bcd2bin(buf[6]);
 	return state;
 }
 
 HAL_StatusTypeDef RTC_getYear(uint8_t * year)
 {
 	HAL_StatusTypeDef state;
-	*year = 0x06;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, year, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, year, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x06, year, 1);
 	*year = bcd2bin(*year);
 	return state;
 }
@@ -140,9 +181,7 @@ HAL_StatusTypeDef RTC_getYear(uint8_t * year)
 HAL_StatusTypeDef RTC_getMonth(uint8_t * month)
 {
 	HAL_StatusTypeDef state;
-	*month = 0x05;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, month, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, month, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x05, month, 1);
 	*month = bcd2bin(*month);
 	return state;
 }
@@ -150,9 +189,7 @@ HAL_StatusTypeDef RTC_getMonth(uint8_t * month)
 HAL_StatusTypeDef RCT_getDateNumber(uint8_t * dateNumber)
 {
 	HAL_StatusTypeDef state;
-	*dateNumber = 0x04;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, dateNumber, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, dateNumber, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x04, dateNumber, 1);
 	*dateNumber = bcd2bin(*dateNumber);
 	return state;
 }
@@ -160,40 +197,22 @@ HAL_StatusTypeDef RCT_getDateNumber(uint8_t * dateNumber)
 HAL_StatusTypeDef RTC_getDay(uint8_t * day)
 {
 	HAL_StatusTypeDef state;
-	*day = 0x03;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, day, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, day, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x03, day, 1);
 	return state;
 }
 
 HAL_StatusTypeDef RTC_getHour(uint8_t * hour, uint8_t * hourMode, TIME_12H_t * time)
 {
 	HAL_StatusTypeDef state;
-	*hour = 0x02;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, hour, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, hour, 1, HAL_MAX_DELAY);
-	*hourMode = (*hour & 0x40)>>6;
-	if(*hourMode)
-	{
-		//12H
-		*time = (*hour & 0x20)>>5;
-		*hour = bcd2bin((*hour & 0x1F));
-	}
-	else
-	{
-		//24H
-		*time = AM_PM_NONE;
-		*hour = bcd2bin((*hour & 0x3F));
-	}
+	state = IIC_Read(RTC_addr, 0x02, hour, 1);
+	RTC_decodeHour(*hour, hour, hourMode, time);
 	return state;
 }
 
 HAL_StatusTypeDef RTC_getMinutes(uint8_t * minutes)
 {
 	HAL_StatusTypeDef state;
-	*minutes = 0x01;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, minutes, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, minutes, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x01, minutes, 1);
 	*minutes = bcd2bin(*minutes);
 	return state;
 }
@@ -201,9 +220,7 @@ HAL_StatusTypeDef RTC_getMinutes(uint8_t * minutes)
 HAL_StatusTypeDef RTC_getSeconds(uint8_t * seconds)
 {
 	HAL_StatusTypeDef state;
-	*seconds = 0x00;
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, seconds, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, seconds, 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, 0x00, seconds, 1);
 	*seconds = bcd2bin(*seconds);
 	return state;
 }
@@ -234,7 +251,7 @@ HAL_StatusTypeDef RTC_setYear(uint8_t year)
 	buf[0] = 0x06;
 	buf[1] = bin2bcd(year);
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -247,7 +264,7 @@ HAL_StatusTypeDef RTC_setMonth(uint8_t month)
 	buf[0] = 0x05;
 	buf[1] = bin2bcd(month);
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -260,7 +277,7 @@ HAL_StatusTypeDef RTC_setDateNumber(uint8_t date)
 	buf[0] = 0x04;
 	buf[1] = bin2bcd(date);
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -273,7 +290,7 @@ HAL_StatusTypeDef RTC_setDay(uint8_t day)
 	buf[0] = 0x03;
 	buf[1] = bin2bcd(day);
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -313,7 +330,7 @@ HAL_StatusTypeDef RTC_setHour(uint8_t hour, uint8_t hourMode, TIME_12H_t time)
 		buf[1] &= 0x3F;
 	}
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -326,7 +343,7 @@ HAL_StatusTypeDef RTC_setMinutes(uint8_t minutes)
 	buf[0] = 0x01;
 	buf[1] = bin2bcd(minutes);
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -338,8 +355,7 @@ HAL_StatusTypeDef RTC_setSeconds(uint8_t seconds)
 	uint8_t buf[2];
 	buf[0] = 0x00;
 
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 1, HAL_MAX_DELAY);
-	state = HAL_I2C_Master_Receive(&hi2c1, RTC_addr, &buf[1], 1, HAL_MAX_DELAY);
+	state = IIC_Read(RTC_addr, buf[0], &buf[1], 1);
 	if((buf[1]&0x80)>>7)
 	{
 		buf[1] = bin2bcd(seconds)|0x80;
@@ -348,7 +364,7 @@ HAL_StatusTypeDef RTC_setSeconds(uint8_t seconds)
 	{
 		buf[1] = bin2bcd(seconds)&0x7F;
 	}
-	state = HAL_I2C_Master_Transmit(&hi2c1, RTC_addr, buf, 2, HAL_MAX_DELAY);
+	state = IIC_Write(RTC_addr, buf[0], &buf[1], 1);
 	return state;
 }
 
@@ -365,3 +381,135 @@ uint8_t bin2bcd(uint8_t value)
 	return value + 6 * (value / 10);
 }
 
+void RTC_decodeHour(uint8_t reg, uint8_t * hour, uint8_t * hourMode, TIME_12H_t * time)
+{
+	*hourMode = (reg & 0x40)>>6;
+	if(*hourMode)
+	{
+		//12H
+		*time = (reg & 0x20)>>5;
+		*hour = bcd2bin((reg & 0x1F));
+	}
+	else
+	{
+		//24H
+		*time = AM_PM_NONE;
+		*hour = bcd2bin((reg & 0x3F));
+	}
+}
+
+/*
+ * RTC_toTimestamp
+ * @brief
+ * Convert a date read on the RTC to a number of seconds since 01/01/2000 00:00:00
+ * The 12H format is converted to 24H before the calculation
+ * @param
+ * RTC_Date	:	Pointer of the date to convert
+ * @return
+ * uint32_t	:	Number of seconds since 01/01/2000 00:00:00
+ */
+uint32_t RTC_toTimestamp(RTC_Date_t * RTC_Date)
+{
+	static const uint16_t daysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+	uint32_t days;
+	uint8_t hour = RTC_Date->hour;
+
+	if(RTC_Date->hourMode == HOUR_TYPE_12H)
+	{
+		hour %= 12;
+		if(RTC_Date->timeMode == PM_12H)
+		{
+			hour += 12;
+		}
+	}
+
+	//Days of the full years elapsed, one more day for each leap year (2000 included)
+	days = RTC_Date->year * 365UL;
+	if(RTC_Date->year > 0)
+	{
+		days += (RTC_Date->year - 1) / 4 + 1;
+	}
+
+	days += daysBeforeMonth[(RTC_Date->month - 1) % 12];
+	if(RTC_Date->month > 2 && RTC_isLeapYear(RTC_Date->year))
+	{
+		days++;
+	}
+	days += RTC_Date->dateNumber - 1;
+
+	return days * RTC_SECONDS_PER_DAY + hour * 3600UL + RTC_Date->minutes * 60UL + RTC_Date->seconds;
+}
+
+/*
+ * RTC_fromTimestamp
+ * @brief
+ * Convert a number of seconds since 01/01/2000 00:00:00 to a date in the 24H format
+ * The day of the week is numbered from 1 (Monday) to 7 (Sunday)
+ * @param
+ * timestamp	:	Number of seconds since 01/01/2000 00:00:00
+ * RTC_Date		:	Pointer of the structure where the date will be saved
+ * @return
+ * none
+ */
+void RTC_fromTimestamp(uint32_t timestamp, RTC_Date_t * RTC_Date)
+{
+	static const uint8_t daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+	uint32_t days = timestamp / RTC_SECONDS_PER_DAY;
+	uint32_t seconds = timestamp % RTC_SECONDS_PER_DAY;
+	uint16_t length;
+
+	RTC_Date->hour = seconds / 3600;
+	RTC_Date->minutes = (seconds / 60) % 60;
+	RTC_Date->seconds = seconds % 60;
+	RTC_Date->hourMode = HOUR_TYPE_24H;
+	RTC_Date->timeMode = AM_PM_NONE;
+
+	//01/01/2000 was a Saturday
+	RTC_Date->day = (days + 5) % 7 + 1;
+
+	RTC_Date->year = 0;
+	length = 366;
+	while(days >= length)
+	{
+		days -= length;
+		RTC_Date->year++;
+		length = RTC_isLeapYear(RTC_Date->year) ? 366 : 365;
+	}
+
+	RTC_Date->month = 0;
+	length = daysInMonth[0];
+	while(days >= length)
+	{
+		days -= length;
+		RTC_Date->month++;
+		length = daysInMonth[RTC_Date->month];
+		if(RTC_Date->month == 1 && RTC_isLeapYear(RTC_Date->year))
+		{
+			length++;
+		}
+	}
+	RTC_Date->month++;
+	RTC_Date->dateNumber = days + 1;
+}
+
+uint8_t RTC_isLeapYear(uint8_t year)
+{
+	return (year % 4) == 0;
+}
+
+/*
+ * RTC_isDateValid
+ * @brief
+ * Check that each field of a date read from the RTC is in its range
+ * @param
+ * RTC_Date	:	Date read by RTC_getDate
+ * @return
+ * uint8_t : 1 if the date is valid
+ */
+uint8_t RTC_isDateValid(RTC_Date_t * RTC_Date)
+{
+	uint8_t hour = (RTC_Date->hourMode == HOUR_TYPE_12H) ? IS_12HOUR(RTC_Date->hour) : IS_24HOUR(RTC_Date->hour);
+
+	return IS_SECONDS_MINUTES(RTC_Date->seconds) && IS_SECONDS_MINUTES(RTC_Date->minutes) && hour
+		&& IS_DAY(RTC_Date->day) && IS_DATE(RTC_Date->dateNumber) && IS_MONTH(RTC_Date->month) && IS_YEAR(RTC_Date->year);
+}
@@ -0,0 +1,249 @@
+/*
+ * Retention.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Retention.h"
+#include "LogIndex.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+uint32_t RET_HourlyIndex[IDX_PAGES(LOG_HOURLY_SIZE)];
+uint32_t RET_DailyIndex[IDX_PAGES(LOG_DAILY_SIZE)];
+uint8_t RET_HourlyPage[EE_SIZE_PAGE];
+uint8_t RET_DailyPage[EE_SIZE_PAGE];
+
+LOG_Ring_t RET_Ring[2] =
+{
+	{LOG_HOURLY_START, LOG_HOURLY_SIZE, LOG_HOURLY_START, 0, RET_HourlyIndex, RET_HourlyPage, NULL},
+	{LOG_DAILY_START, LOG_DAILY_SIZE, LOG_DAILY_START, 0, RET_DailyIndex, RET_DailyPage, NULL}
+};
+
+RET_Callback_t RET_UserCallback;
+
+RET_Rollup_t RET_Current[2];		// Rollups of the current hour and of the current day
+uint8_t RET_isOpen[2] = {0, 0};
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+void RET_Open(RET_Tier_t tier, uint32_t start, uint8_t flags);
+void RET_Merge(RET_Rollup_t * rollup, RET_Rollup_t * part);
+HAL_StatusTypeDef RET_Close(RET_Tier_t tier);
+void RET_RollupVisitor(uint8_t * record);
+
+
+/***************************************************************************************/
+/*
+ * RET_Init
+ * @brief
+ * Initialize the retention tiers.
+ * The index of each tier is rebuilt from the device and the tier goes on after its newest rollup.
+ * The rollups in progress are lost on reset, so the first hour and the first day are flagged partial.
+ * @param
+ * device : Storage device of the tiers (STO_Eeprom)
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef RET_Init(const STO_Device_t * device)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+
+	for(uint8_t tier = RET_TIER_HOURLY; tier <= RET_TIER_DAILY; tier++)
+	{
+		RET_isOpen[tier] = 0;
+		RET_Ring[tier].device = device;
+
+		if(LOG_RingInit(&RET_Ring[tier], RET_ROLLUP_SIZE) != HAL_OK)
+		{
+			state = HAL_ERROR;
+		}
+	}
+
+	return state;
+}
+
+/*
+ * RET_Add
+ * @brief
+ * Give a new sample to the hourly and daily rollups.
+ * The rollups are updated incrementally. When a sample belongs to a new hour,
+ * the previous hour is stored and merged in the daily rollup, which is stored in turn on a new day.
+ * @param
+ * timestamp	:	Time of the sample in seconds since 01/01/2000 00:00:00
+ * value		:	Value of the sample
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef RET_Add(uint32_t timestamp, int16_t value)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	RET_Rollup_t * hour = &RET_Current[RET_TIER_HOURLY];
+
+	if(RET_isOpen[RET_TIER_HOURLY] && timestamp - hour->timestamp >= RET_HOUR)
+	{
+		state = RET_Close(RET_TIER_HOURLY);
+	}
+
+	if(RET_isOpen[RET_TIER_DAILY] && timestamp - RET_Current[RET_TIER_DAILY].timestamp >= RET_DAY)
+	{
+		state = RET_Close(RET_TIER_DAILY);
+	}
+
+	if(!RET_isOpen[RET_TIER_DAILY])
+	{
+		RET_Open(RET_TIER_DAILY, timestamp - timestamp % RET_DAY, timestamp % RET_DAY ? RET_FLAG_PARTIAL : 0);
+	}
+
+	if(!RET_isOpen[RET_TIER_HOURLY])
+	{
+		RET_Open(RET_TIER_HOURLY, timestamp - timestamp % RET_HOUR, timestamp % RET_HOUR ? RET_FLAG_PARTIAL : 0);
+	}
+
+	if(hour->count == 0 || value < hour->min)
+	{
+		hour->min = value;
+	}
+	if(hour->count == 0 || value > hour->max)
+	{
+		hour->max = value;
+	}
+	hour->sum += value;
+	hour->count++;
+
+	return state;
+}
+
+/*
+ * RET_Export
+ * @brief
+ * Read the rollups of a tier, from the oldest to the newest
+ * The rollups of a page with a wrong CRC are not given to the callback.
+ * @param
+ * tier		:	RET_TIER_HOURLY or RET_TIER_DAILY
+ * callback	:	Function called for each rollup
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef RET_Export(RET_Tier_t tier, RET_Callback_t callback)
+{
+	LOG_Ring_t * ring = &RET_Ring[tier];
+
+	RET_UserCallback = callback;
+
+	return LOG_RingScan(ring, RET_ROLLUP_SIZE, LOG_RingOldest(ring), 0, IDX_EMPTY - 1, RET_RollupVisitor);
+}
+
+/*
+ * RET_Open
+ * @brief
+ * Start a new rollup
+ * @param
+ * tier		:	RET_TIER_HOURLY or RET_TIER_DAILY
+ * start	:	Start of the period
+ * flags	:	RET_FLAG_xxx
+ * @return
+ * none
+ */
+void RET_Open(RET_Tier_t tier, uint32_t start, uint8_t flags)
+{
+	RET_Rollup_t * rollup = &RET_Current[tier];
+
+	rollup->timestamp = start;
+	rollup->min = 0;
+	rollup->max = 0;
+	rollup->sum = 0;
+	rollup->count = 0;
+	rollup->channel = LOG_CHANNEL_TEMPERATURE;
+	rollup->flags = flags;
+
+	RET_isOpen[tier] = 1;
+}
+
+/*
+ * RET_Merge
+ * @brief
+ * Add the samples summarized by a rollup to another one
+ * @param
+ * rollup	:	Rollup to be updated
+ * part		:	Rollup to be added
+ * @return
+ * none
+ */
+void RET_Merge(RET_Rollup_t * rollup, RET_Rollup_t * part)
+{
+	if(part->count == 0)
+	{
+		return;
+	}
+
+	if(rollup->count == 0 || part->min < rollup->min)
+	{
+		rollup->min = part->min;
+	}
+	if(rollup->count == 0 || part->max > rollup->max)
+	{
+		rollup->max = part->max;
+	}
+	rollup->sum += part->sum;
+	rollup->count += part->count;
+}
+
+/*
+ * RET_Close
+ * @brief
+ * Store the rollup in progress of a tier.
+ * An hourly rollup is merged in the daily rollup before being stored.
+ * @param
+ * tier : RET_TIER_HOURLY or RET_TIER_DAILY
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef RET_Close(RET_Tier_t tier)
+{
+	HAL_StatusTypeDef state;
+
+	if(tier == RET_TIER_HOURLY)
+	{
+		RET_Merge(&RET_Current[RET_TIER_DAILY], &RET_Current[RET_TIER_HOURLY]);
+	}
+
+	state = LOG_RingWrite(&RET_Ring[tier], (uint8_t *)&RET_Current[tier], RET_ROLLUP_SIZE);
+
+	RET_isOpen[tier] = 0;
+
+	return state;
+}
+
+/*
+ * RET_RollupVisitor
+ * @brief
+ * Give a rollup read by LOG_RingScan to the callback of RET_Export
+ * @param
+ * record : Rollup read
+ * @return
+ * none
+ */
+void RET_RollupVisitor(uint8_t * record)
+{
+	RET_UserCallback((RET_Rollup_t *)record);
+}
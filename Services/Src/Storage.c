@@ -0,0 +1,281 @@
+/*
+ * Storage.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Storage.h"
+#include "Eeprom.h"
+#include "Wear.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+STO_Stats_t STO_Stats = {0, 0, 0, 0, 0};
+
+
+/*
+ * PUBLIC GLOBAL VARIABLE
+ */
+#ifndef STO_HOST
+//SPI2 EEPROM : 512 KB written in place by pages of 256 Bytes
+const STO_Device_t STO_Eeprom =
+{
+	EE_SIZE_MEMORY,
+	EE_SIZE_PAGE,
+	STO_NO_ERASE,
+	EE_Read,
+	EE_Write,
+	EE_Stream,
+	EE_isBusy,
+	NULL
+};
+#endif
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint8_t STO_isInside(const STO_Device_t * device, uint32_t addr, uint32_t length);
+
+
+/***************************************************************************************/
+/*
+ * STO_Read
+ * @brief
+ * Read Bytes from a device
+ * @param
+ * device	:	Storage device
+ * addr		:	Address of start of reading
+ * data		:	Buffer of the Bytes read
+ * length	:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR		range outside of the device
+ */
+HAL_StatusTypeDef STO_Read(const STO_Device_t * device, uint32_t addr, uint8_t * data, uint16_t length)
+{
+	if(!STO_isInside(device, addr, length))
+	{
+		return HAL_ERROR;
+	}
+
+	STO_Stats.reads++;
+	STO_Stats.readBytes += length;
+
+	return device->read(addr, data, length);
+}
+
+/*
+ * STO_Program
+ * @brief
+ * Program Bytes in a device, the driver splits them on its pages.
+ * On a device with sectors, the Bytes must have been erased (see STO_Erase).
+ * The pages programmed in the EEPROM are counted for its wear (see STO_Count).
+ * @param
+ * device	:	Storage device
+ * addr		:	Start address of the writing process
+ * data		:	Buffer of data to be written
+ * length	:	Number of Bytes to be written
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR		range outside of the device
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef STO_Program(const STO_Device_t * device, uint32_t addr, uint8_t * data, uint16_t length)
+{
+	HAL_StatusTypeDef state;
+
+	if(!STO_isInside(device, addr, length))
+	{
+		return HAL_ERROR;
+	}
+
+	STO_Stats.programs++;
+	STO_Stats.programBytes += length;
+
+	state = device->program(addr, data, length);
+	if(state == HAL_OK)
+	{
+		STO_Count(device, addr, length);
+	}
+
+	return state;
+}
+
+/*
+ * STO_Stream
+ * @brief
+ * Read a range of a device by chunks given to a callback (see EE_Stream).
+ * A device without stream function is read chunk by chunk with its read function.
+ * @param
+ * device	:	Storage device
+ * addr		:	Address of start of reading
+ * length	:	Number of Bytes to read
+ * buffer	:	Chunk buffer owned by the caller
+ * size		:	Size of the chunk buffer
+ * callback	:	Function called with each chunk, returns 0 to stop the read
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK		range read, or read stopped by the callback
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef STO_Stream(const STO_Device_t * device, uint32_t addr, uint32_t length, uint8_t * buffer, uint16_t size, STO_Callback_t callback)
+{
+	HAL_StatusTypeDef state = HAL_OK;
+	uint16_t part;
+
+	if(!STO_isInside(device, addr, length) || size == 0)
+	{
+		return HAL_ERROR;
+	}
+
+	STO_Stats.reads++;
+	STO_Stats.readBytes += length;
+
+	if(device->stream != NULL)
+	{
+		return device->stream(addr, length, buffer, size, callback);
+	}
+
+	while(length && state == HAL_OK)
+	{
+		part = (length > size) ? size : length;
+		state = device->read(addr, buffer, part);
+		if(state == HAL_OK && !callback(buffer, part))
+		{
+			break;
+		}
+		addr += part;
+		length -= part;
+	}
+
+	return state;
+}
+
+/*
+ * STO_Erase
+ * @brief
+ * Erase the sector of an address, the Bytes of the sector read 0xFF.
+ * Nothing to do on a device written in place.
+ * @param
+ * device	:	Storage device
+ * addr		:	Address in the sector
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef STO_Erase(const STO_Device_t * device, uint32_t addr)
+{
+	if(device->sector == STO_NO_ERASE || device->erase == NULL)
+	{
+		return HAL_OK;
+	}
+	if(!STO_isInside(device, addr, 1))
+	{
+		return HAL_ERROR;
+	}
+
+	STO_Stats.erases++;
+
+	return device->erase(addr - addr % device->sector);
+}
+
+/*
+ * STO_Count
+ * @brief
+ * Count the program cycles of the pages of the EEPROM written by a program (see Wear.h).
+ * Called by STO_Program, and by the modules which write the EEPROM with its driver (vectored writes).
+ * The EEPROM is written in place, no erase is counted.
+ * @param
+ * device	:	Storage device written
+ * addr		:	Start address of the writing process
+ * length	:	Number of Bytes written
+ * @return
+ * none
+ */
+void STO_Count(const STO_Device_t * device, uint32_t addr, uint32_t length)
+{
+#ifndef STO_HOST
+	if(device != &STO_Eeprom || length == 0)
+	{
+		return;
+	}
+
+	for(uint32_t page = addr / EE_SIZE_PAGE; page <= (addr + length - 1) / EE_SIZE_PAGE; page++)
+	{
+		WEAR_Count(page);
+	}
+#endif
+}
+
+/*
+ * STO_isBusy
+ * @brief
+ * Check if a device is still programming or erasing
+ * @param
+ * device	:	Storage device
+ * @return
+ * uint8_t : 1 while busy
+ */
+uint8_t STO_isBusy(const STO_Device_t * device)
+{
+	return device->isBusy();
+}
+
+/*
+ * STO_getStats
+ * @brief
+ * Get the accesses to the devices since the reset
+ * @param
+ * stats : Counters of the accesses
+ * @return
+ * none
+ */
+void STO_getStats(STO_Stats_t * stats)
+{
+	*stats = STO_Stats;
+}
+
+/*
+ * STO_ResetStats
+ * @brief
+ * Clear the counters of the accesses, before a benchmark
+ * @param
+ * none
+ * @return
+ * none
+ */
+void STO_ResetStats(void)
+{
+	STO_Stats = (STO_Stats_t){0, 0, 0, 0, 0};
+}
+
+/*
+ * STO_isInside
+ * @brief
+ * Check that a range is inside a device
+ * @param
+ * device	:	Storage device
+ * addr		:	First address of the range
+ * length	:	Number of Bytes
+ * @return
+ * uint8_t : 1 if the range is inside the device
+ */
+uint8_t STO_isInside(const STO_Device_t * device, uint32_t addr, uint32_t length)
+{
+	return device != NULL && addr < device->size && length <= device->size - addr;
+}
@@ -0,0 +1,275 @@
+/*
+ * StorageFile.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * Storage device backed by a file, for the builds of the log layers on a Linux host (-DSTO_HOST).
+ * A device with sectors behaves as a NOR flash : a program can only clear bits, an erase sets
+ * the whole sector to 0xFF. Without sectors, the Bytes are overwritten as on the EEPROM.
+ * A device with sectors also simulates the time of a flash : it stays busy for some polls of
+ * isBusy after a program or an erase, and counts the misuses (see STO_FileGetErrors).
+ * Only one file is open at a time, the functions of the device have no context.
+ */
+#ifdef STO_HOST
+
+/*
+ * INCLUDE FILES
+ */
+#include <stdio.h>
+#include <string.h>
+#include "Storage.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define STO_FILE_CHUNK			256			// Bytes handled at once by a program or an erase
+#define STO_FILE_PROGRAM_POLLS	1			// Polls of isBusy answered busy after a program
+#define STO_FILE_ERASE_POLLS	20			// Polls of isBusy answered busy after an erase
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+FILE * STO_File = NULL;
+STO_Device_t STO_FileDevice;
+uint32_t STO_FileBusy = 0;				// Polls of isBusy left before the end of the operation
+uint32_t STO_FileErrors = 0;			// Programs of Bytes not erased, operations started while busy
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+HAL_StatusTypeDef STO_FileRead(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef STO_FileProgram(uint32_t addr, uint8_t * data, uint16_t length);
+HAL_StatusTypeDef STO_FileErase(uint32_t addr);
+uint8_t STO_FileIsBusy(void);
+
+
+/***************************************************************************************/
+/*
+ * STO_FileOpen
+ * @brief
+ * Open the file of the device, it is created erased (0xFF) if it does not exist or is too short
+ * @param
+ * path		:	Path of the file
+ * size		:	Capacity of the device (Bytes)
+ * page		:	Program page of the device (Bytes)
+ * sector	:	Erase unit of the device (Bytes), STO_NO_ERASE for an EEPROM
+ * @return
+ * const STO_Device_t * : Device, NULL if the file cannot be opened
+ */
+const STO_Device_t * STO_FileOpen(const char * path, uint32_t size, uint16_t page, uint32_t sector)
+{
+	uint8_t erased[STO_FILE_CHUNK];
+	long length;
+
+	STO_FileClose();
+
+	STO_File = fopen(path, "r+b");
+	if(STO_File == NULL)
+	{
+		STO_File = fopen(path, "w+b");
+	}
+	if(STO_File == NULL)
+	{
+		return NULL;
+	}
+
+	fseek(STO_File, 0, SEEK_END);
+	length = ftell(STO_File);
+	memset(erased, 0xFF, sizeof(erased));
+	while(length < (long)size)
+	{
+		fwrite(erased, 1, (size - length > sizeof(erased)) ? sizeof(erased) : size - length, STO_File);
+		length = ftell(STO_File);
+	}
+
+	STO_FileDevice.size = size;
+	STO_FileDevice.page = page;
+	STO_FileDevice.sector = sector;
+	STO_FileDevice.read = STO_FileRead;
+	STO_FileDevice.program = STO_FileProgram;
+	STO_FileDevice.stream = NULL;
+	STO_FileDevice.isBusy = STO_FileIsBusy;
+	STO_FileDevice.erase = (sector == STO_NO_ERASE) ? NULL : STO_FileErase;
+	STO_FileBusy = 0;
+	STO_FileErrors = 0;
+
+	return &STO_FileDevice;
+}
+
+/*
+ * STO_FileClose
+ * @brief
+ * Close the file of the device
+ * @param
+ * none
+ * @return
+ * none
+ */
+void STO_FileClose(void)
+{
+	if(STO_File != NULL)
+	{
+		fclose(STO_File);
+		STO_File = NULL;
+	}
+}
+
+/*
+ * STO_FileGetErrors
+ * @brief
+ * Get the misuses of a device with sectors since STO_FileOpen : a bit programmed from 0 to 1
+ * (Byte not erased), or a program or an erase started before the end of the previous one
+ * @param
+ * none
+ * @return
+ * uint32_t : Number of misuses
+ */
+uint32_t STO_FileGetErrors(void)
+{
+	return STO_FileErrors;
+}
+
+/*
+ * STO_FileRead
+ * @brief
+ * Read Bytes of the file
+ * @param
+ * addr		:	Address of start of reading
+ * data		:	Buffer of the Bytes read
+ * length	:	Number of Bytes to be read
+ * @return
+ * HAL_StatusTypeDef : Status of the access
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef STO_FileRead(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	if(STO_File == NULL || fseek(STO_File, addr, SEEK_SET) != 0 || fread(data, 1, length, STO_File) != length)
+	{
+		return HAL_ERROR;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * STO_FileProgram
+ * @brief
+ * Program Bytes of the file, only the bits at 1 can be cleared on a device with sectors
+ * @param
+ * addr		:	Start address of the writing process
+ * data		:	Buffer of data to be written
+ * length	:	Number of Bytes to be written
+ * @return
+ * HAL_StatusTypeDef : Status of the access
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef STO_FileProgram(uint32_t addr, uint8_t * data, uint16_t length)
+{
+	uint8_t chunk[STO_FILE_CHUNK];
+	uint16_t part;
+
+	if(STO_FileDevice.sector != STO_NO_ERASE)
+	{
+		if(STO_FileBusy)
+		{
+			STO_FileErrors++;
+		}
+		STO_FileBusy = STO_FILE_PROGRAM_POLLS;
+	}
+
+	while(length)
+	{
+		part = (length > sizeof(chunk)) ? sizeof(chunk) : length;
+
+		memcpy(chunk, data, part);
+		if(STO_FileDevice.sector != STO_NO_ERASE)
+		{
+			uint8_t old[STO_FILE_CHUNK];
+
+			if(STO_FileRead(addr, old, part) != HAL_OK)
+			{
+				return HAL_ERROR;
+			}
+			for(uint16_t i = 0; i < part; i++)
+			{
+				if(chunk[i] & ~old[i])
+				{
+					STO_FileErrors++;
+				}
+				chunk[i] &= old[i];
+			}
+		}
+
+		if(STO_File == NULL || fseek(STO_File, addr, SEEK_SET) != 0 || fwrite(chunk, 1, part, STO_File) != part)
+		{
+			return HAL_ERROR;
+		}
+
+		addr += part;
+		data += part;
+		length -= part;
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * STO_FileErase
+ * @brief
+ * Erase a sector of the file
+ * @param
+ * addr : First address of the sector
+ * @return
+ * HAL_StatusTypeDef : Status of the access
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef STO_FileErase(uint32_t addr)
+{
+	uint8_t erased[STO_FILE_CHUNK];
+
+	if(STO_FileBusy)
+	{
+		STO_FileErrors++;
+	}
+	STO_FileBusy = STO_FILE_ERASE_POLLS;
+
+	memset(erased, 0xFF, sizeof(erased));
+	for(uint32_t offset = 0; offset < STO_FileDevice.sector; offset += sizeof(erased))
+	{
+		if(STO_File == NULL || fseek(STO_File, addr + offset, SEEK_SET) != 0 || fwrite(erased, 1, sizeof(erased), STO_File) != sizeof(erased))
+		{
+			return HAL_ERROR;
+		}
+	}
+
+	return HAL_OK;
+}
+
+/*
+ * STO_FileIsBusy
+ * @brief
+ * Simulate the end of a program or an erase after some polls
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 while busy
+ */
+uint8_t STO_FileIsBusy(void)
+{
+	if(STO_FileBusy)
+	{
+		STO_FileBusy--;
+		return 1;
+	}
+
+	return 0;
+}
+
+#endif /* STO_HOST */
@@ -14,46 +14,228 @@
 /*
  * PRIVATE CONSTANTS
  */
+//Factory calibration of the MCU, measured at VDDA = 3.3 V
+#define TS_VREFINT_CAL			(*(const uint16_t *)0x1FFFF7BA)	// Raw VREFINT at 30 °C
+#define TS_CAL1					(*(const uint16_t *)0x1FFFF7B8)	// Raw internal sensor at 30 °C
+#define TS_CAL2					(*(const uint16_t *)0x1FFFF7C2)	// Raw internal sensor at 110 °C
+#define TS_CAL1_TEMP			3000							// 1/100 °C
+#define TS_CAL2_TEMP			11000							// 1/100 °C
+
+/*
+ * Curve of the external sensor : 1/100 °C for a raw value at VDDA = 3.3 V.
+ * The table is generated by the compiler from TS_CURVE, one point every TS_LUT_STEP,
+ * and read with a linear interpolation between two points.
+ */
+#define TS_LUT_SHIFT			6
+#define TS_LUT_STEP				(1 << TS_LUT_SHIFT)
+#define TS_LUT_SIZE				((TS_ADC_FULL_SCALE + 1) / TS_LUT_STEP + 1)
+
+#define TS_CURVE(raw)			((int32_t)(raw) * 10 - 5000)		// 10 counts per °C, 500 counts at 0 °C
+
+#define TS_LUT_1(i)				TS_CURVE((i) * TS_LUT_STEP),
+#define TS_LUT_4(i)				TS_LUT_1(i) TS_LUT_1((i) + 1) TS_LUT_1((i) + 2) TS_LUT_1((i) + 3)
+#define TS_LUT_16(i)			TS_LUT_4(i) TS_LUT_4((i) + 4) TS_LUT_4((i) + 8) TS_LUT_4((i) + 12)
+#define TS_LUT_64(i)			TS_LUT_16(i) TS_LUT_16((i) + 16) TS_LUT_16((i) + 32) TS_LUT_16((i) + 48)
 
 /*
  * PRIVATE GLOBAL VARIABLES
  */
+const int32_t TS_Lut[TS_LUT_SIZE] = {TS_LUT_64(0) TS_LUT_1(64)};
 
 
 /*
  * PRIVATE FUNCTION PROTOTYPES
  */
+uint16_t TS_Compensate(uint16_t raw, uint16_t vrefint);
+int16_t TS_Saturate(int32_t value);
 
 
 /***************************************************************************************/
 
+/* @function
+ * TS_Init
+ *
+ * @brief
+ * This function calibrates the offset of ADC1 in single ended mode.
+ * It must be called once after MX_ADC1_Init, before the first conversion.
+ *
+ * @param
+ * None
+ *
+ * @return
+ * HAL_StatusTypeDef : Status of the calibration
+ */
+HAL_StatusTypeDef TS_Init(void)
+{
+	return HAL_ADCEx_Calibration_Start(&hadc1, ADC_SINGLE_ENDED);
+}
+
 /* @function
  * TS_getTemperature
  *
  * @brief
  * This function get the temperature value.
- * First, it starts the ADC, then converts the voltage in a unsigned integer value it gets and then fetch the integer value.
- * Last, it converts again the integer value to celcius degree.
+ * The sensor and VREFINT are converted in one scan of the ADC, then the value is compensated
+ * for the supply voltage and converted to 1/100 of celcius degree.
  *
  * @param
- * None
+ * temperature : pointer of a variable to save the temperature in 1/100 °C
  *
  * @return
- * uint32_t : converted value of the temperature in °C
+ * HAL_StatusTypeDef : Status of the conversion
  */
-uint32_t TS_getTemperature(void)
+HAL_StatusTypeDef TS_getTemperature(int16_t * temperature)
 {
-	uint32_t temp;
+	HAL_StatusTypeDef state;
+	uint16_t values[2];
+
+	state = AS_Read(LOG_CHANNEL_TEMPERATURE | LOG_CHANNEL_VREFINT, values);
+	if(state == HAL_OK)
+	{
+		*temperature = TS_toTemperature(values[0], values[1]);
+	}
 
-	HAL_ADC_Start(&hadc1);
+	return state;
+}
+
+/* @function
+ * TS_toTemperature
+ *
+ * @brief
+ * This function converts a raw value of the external sensor (ADC1_IN1) to 1/100 of celcius degree.
+ * The value is first brought back to VDDA = 3.3 V with VREFINT, then read in the table of the sensor.
+ * Integer only, constant time.
+ *
+ * @param
+ * raw		: value of the sensor converted by the ADC
+ * vrefint	: value of VREFINT converted in the same scan
+ *
+ * @return
+ * int16_t : temperature in 1/100 °C
+ */
+int16_t TS_toTemperature(uint16_t raw, uint16_t vrefint)
+{
+	uint16_t value = TS_Compensate(raw, vrefint);
+	uint16_t index = value >> TS_LUT_SHIFT;
+	int32_t fraction = value & (TS_LUT_STEP - 1);
 
-	HAL_ADC_PollForConversion(&hadc1, HAL_MAX_DELAY);
+	return TS_Saturate(TS_Lut[index] + (TS_Lut[index + 1] - TS_Lut[index]) * fraction / TS_LUT_STEP);
+}
 
-	temp = HAL_ADC_GetValue(&hadc1);
+/* @function
+ * TS_toMcuTemperature
+ *
+ * @brief
+ * This function converts a raw value of the internal sensor of the MCU (ADC1_IN16) to 1/100 of celcius degree,
+ * with the two calibration points of the factory.
+ *
+ * @param
+ * raw		: value of the internal sensor converted by the ADC
+ * vrefint	: value of VREFINT converted in the same scan
+ *
+ * @return
+ * int16_t : temperature in 1/100 °C
+ */
+int16_t TS_toMcuTemperature(uint16_t raw, uint16_t vrefint)
+{
+	int32_t value = TS_Compensate(raw, vrefint);
 
-	HAL_ADC_Stop(&hadc1);
+	return TS_Saturate(TS_CAL1_TEMP + (value - TS_CAL1) * (TS_CAL2_TEMP - TS_CAL1_TEMP) / (TS_CAL2 - TS_CAL1));
+}
 
-	temp = temp / 10 - 50;
+/* @function
+ * TS_toVdda
+ *
+ * @brief
+ * This function computes the supply voltage of the ADC from VREFINT.
+ *
+ * @param
+ * vrefint : value of VREFINT converted by the ADC
+ *
+ * @return
+ * uint16_t : VDDA in mV
+ */
+uint16_t TS_toVdda(uint16_t vrefint)
+{
+	if(vrefint == 0)
+	{
+		return 0;
+	}
+
+	return (uint32_t)TS_VDDA_CAL * TS_VREFINT_CAL / vrefint;
+}
+
+/* @function
+ * TS_toVbat
+ *
+ * @brief
+ * This function converts the value of VBAT (ADC1_IN17, VBAT / 2 on the input) to mV.
+ *
+ * @param
+ * raw		: value of VBAT converted by the ADC
+ * vrefint	: value of VREFINT converted in the same scan
+ *
+ * @return
+ * uint16_t : VBAT in mV
+ */
+uint16_t TS_toVbat(uint16_t raw, uint16_t vrefint)
+{
+	return (uint32_t)TS_Compensate(raw, vrefint) * TS_VDDA_CAL * 2 / TS_ADC_FULL_SCALE;
+}
+
+/* @function
+ * TS_Compensate
+ *
+ * @brief
+ * This function brings a raw value back to the value it would have with VDDA = 3.3 V.
+ *
+ * @param
+ * raw		: value converted by the ADC
+ * vrefint	: value of VREFINT converted in the same scan
+ *
+ * @return
+ * uint16_t : raw value at 3.3 V, limited to the full scale
+ */
+uint16_t TS_Compensate(uint16_t raw, uint16_t vrefint)
+{
+	uint32_t value;
+
+	if(vrefint == 0)
+	{
+		return TS_ADC_FULL_SCALE;
+	}
+
+	value = (uint32_t)raw * TS_VREFINT_CAL / vrefint;
+	if(value > TS_ADC_FULL_SCALE)
+	{
+		value = TS_ADC_FULL_SCALE;
+	}
+
+	return value;
+}
+
+/* @function
+ * TS_Saturate
+ *
+ * @brief
+ * This function limits a temperature to the range of an int16_t.
+ *
+ * @param
+ * value : temperature in 1/100 °C
+ *
+ * @return
+ * int16_t : temperature in 1/100 °C
+ */
+int16_t TS_Saturate(int32_t value)
+{
+	if(value > INT16_MAX)
+	{
+		return INT16_MAX;
+	}
+	if(value < INT16_MIN)
+	{
+		return INT16_MIN;
+	}
 
-	return  temp;
+	return value;
 }
@@ -0,0 +1,346 @@
+/*
+ * Wear.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include "Wear.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define WEAR_EMPTY				0xFFFFFFFF	// Sequence of an erased slot
+
+/*
+ * WEAR_Table_t definition
+ * Copy of the counters stored in a slot of the wear region, 524 Bytes
+ * sequence	: Number of the save since the first one, WEAR_EMPTY for an empty slot
+ * since	: Start of the counting in seconds since 01/01/2000 00:00:00
+ * count	: Page programs of each block of WEAR_BLOCK_PAGES pages
+ * crc		: CRC-32 of the table before this field
+ */
+typedef struct
+{
+	uint32_t sequence;
+	uint32_t since;
+	uint32_t count[WEAR_NB_BLOCKS];
+	uint32_t crc;
+} WEAR_Table_t;
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+WEAR_Table_t WEAR_Table;				// Counters in use, saved as they are
+uint32_t WEAR_Start = 0;				// First address of the wear region
+uint8_t WEAR_NbSlots = 0;				// Slots of the wear region, 0 before WEAR_Init
+uint8_t WEAR_Slot = 0;					// Slot of the last save
+uint32_t WEAR_Unsaved = 0;				// Programs counted since the last save
+uint8_t WEAR_Saving = 0;				// The counters are being written
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint8_t WEAR_isValid(void);
+
+
+/***************************************************************************************/
+/*
+ * WEAR_Init
+ * @brief
+ * Load the newest valid copy of the counters from the wear region. Without any, the counting
+ * starts again from 0 at the current time.
+ * The programs counted since the last save are lost on reset (up to WEAR_SAVE_PROGRAMS).
+ * @param
+ * start	:	First address of the wear region (LOG_WEAR_START), aligned on a page
+ * size		:	Size of the wear region (LOG_WEAR_SIZE)
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ */
+HAL_StatusTypeDef WEAR_Init(uint32_t start, uint32_t size)
+{
+	uint32_t sequence = 0;
+	int16_t newest = -1;
+
+	WEAR_NbSlots = 0;
+	if(size < WEAR_SLOT_SIZE || sizeof(WEAR_Table_t) > WEAR_SLOT_SIZE)
+	{
+		return HAL_ERROR;
+	}
+	WEAR_Start = start;
+
+	//Each slot is read and checked, the newest valid one is read again at the end
+	for(uint8_t slot = 0; slot < size / WEAR_SLOT_SIZE && slot < 0xFF; slot++)
+	{
+		if(EE_Read(start + slot * WEAR_SLOT_SIZE, (uint8_t *)&WEAR_Table, sizeof(WEAR_Table_t)) != HAL_OK)
+		{
+			return HAL_ERROR;
+		}
+		if(WEAR_isValid() && (newest < 0 || WEAR_Table.sequence > sequence))
+		{
+			newest = slot;
+			sequence = WEAR_Table.sequence;
+		}
+		WEAR_NbSlots++;
+	}
+
+	if(newest >= 0)
+	{
+		WEAR_Slot = newest;
+		if(EE_Read(start + newest * WEAR_SLOT_SIZE, (uint8_t *)&WEAR_Table, sizeof(WEAR_Table_t)) != HAL_OK || !WEAR_isValid())
+		{
+			return HAL_ERROR;
+		}
+	}
+	else
+	{
+		memset(&WEAR_Table, 0, sizeof(WEAR_Table_t));
+		WEAR_Table.since = IRTC_getTimestamp();
+		WEAR_Slot = WEAR_NbSlots - 1;
+	}
+	WEAR_Unsaved = 0;
+
+	return HAL_OK;
+}
+
+/*
+ * WEAR_Count
+ * @brief
+ * Count a program cycle of a page, called by the Storage layer for each page written (see STO_Count)
+ * @param
+ * page : Page programmed (0 to EE_LAST_PAGE)
+ * @return
+ * none
+ */
+void WEAR_Count(uint16_t page)
+{
+	//The pages of a save are counted once it is written, the table must not change meanwhile
+	if(WEAR_Saving || page / WEAR_BLOCK_PAGES >= WEAR_NB_BLOCKS)
+	{
+		return;
+	}
+
+	WEAR_Table.count[page / WEAR_BLOCK_PAGES]++;
+	WEAR_Unsaved++;
+}
+
+/*
+ * WEAR_Process
+ * @brief
+ * Save the counters once WEAR_SAVE_PROGRAMS pages were programmed, called from the main loop
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef WEAR_Process(void)
+{
+	if(WEAR_Unsaved < WEAR_SAVE_PROGRAMS)
+	{
+		return HAL_OK;
+	}
+
+	return WEAR_Save();
+}
+
+/*
+ * WEAR_Save
+ * @brief
+ * Write the counters in the next slot of the wear region. The previous copy stays valid
+ * until this one is fully written, the slots share the program cycles of the saves.
+ * @param
+ * none
+ * @return
+ * HAL_StatusTypeDef : Status of the communication
+ * 					- HAL_OK
+ * 					- HAL_ERROR
+ * 					- HAL_TIMEOUT
+ */
+HAL_StatusTypeDef WEAR_Save(void)
+{
+	HAL_StatusTypeDef state;
+	uint32_t addr;
+
+	if(WEAR_NbSlots == 0)
+	{
+		return HAL_ERROR;
+	}
+
+	WEAR_Slot = (WEAR_Slot + 1) % WEAR_NbSlots;
+	addr = WEAR_Start + WEAR_Slot * WEAR_SLOT_SIZE;
+
+	WEAR_Table.sequence++;
+	WEAR_Table.crc = CRC32_Compute((uint8_t *)&WEAR_Table, offsetof(WEAR_Table_t, crc));
+
+	WEAR_Saving = 1;
+	state = EE_Write(addr, (uint8_t *)&WEAR_Table, sizeof(WEAR_Table_t));
+	WEAR_Saving = 0;
+
+	WEAR_Unsaved = 0;
+	for(uint16_t page = addr / EE_SIZE_PAGE; page <= (addr + sizeof(WEAR_Table_t) - 1) / EE_SIZE_PAGE; page++)
+	{
+		WEAR_Count(page);
+	}
+
+	return state;
+}
+
+/*
+ * WEAR_getCount
+ * @brief
+ * Get the program cycles of a block, it is an upper bound of the cycles of each of its pages
+ * @param
+ * block : Block of WEAR_BLOCK_PAGES pages (address / WEAR_BLOCK_SIZE)
+ * @return
+ * uint32_t : Page programs counted in the block
+ */
+uint32_t WEAR_getCount(uint16_t block)
+{
+	if(block >= WEAR_NB_BLOCKS)
+	{
+		return 0;
+	}
+
+	return WEAR_Table.count[block];
+}
+
+/*
+ * WEAR_getHottest
+ * @brief
+ * Find the most programmed block of the EEPROM, the first one to wear out
+ * @param
+ * block : Block found (address / WEAR_BLOCK_SIZE)
+ * @return
+ * uint32_t : Page programs counted in the block
+ */
+uint32_t WEAR_getHottest(uint16_t * block)
+{
+	*block = 0;
+	for(uint16_t k = 1; k < WEAR_NB_BLOCKS; k++)
+	{
+		if(WEAR_Table.count[k] > WEAR_Table.count[*block])
+		{
+			*block = k;
+		}
+	}
+
+	return WEAR_Table.count[*block];
+}
+
+/*
+ * WEAR_getLifetime
+ * @brief
+ * Project the remaining lifetime of the EEPROM : time for the hottest page to reach WEAR_ENDURANCE
+ * at its program rate since the start of the counting. The counter of a block sums the programs of its
+ * WEAR_BLOCK_PAGES pages : it is taken as the count of the hottest page, which may have taken them all.
+ * @param
+ * timestamp : Current time in seconds since 01/01/2000 00:00:00
+ * @return
+ * uint32_t : Remaining lifetime (days), WEAR_UNKNOWN if nothing was counted yet
+ */
+uint32_t WEAR_getLifetime(uint32_t timestamp)
+{
+	uint16_t block;
+	uint32_t count = WEAR_getHottest(&block);
+	uint32_t elapsed;
+	uint64_t days;
+
+	if(count >= WEAR_ENDURANCE)
+	{
+		return 0;
+	}
+	if(count == 0 || timestamp <= WEAR_Table.since)
+	{
+		return WEAR_UNKNOWN;
+	}
+
+	elapsed = timestamp - WEAR_Table.since;
+	days = (uint64_t)(WEAR_ENDURANCE - count) * elapsed / count / RTC_SECONDS_PER_DAY;
+	if(days >= WEAR_UNKNOWN)
+	{
+		days = WEAR_UNKNOWN - 1;
+	}
+
+	return days;
+}
+
+/*
+ * WEAR_Allocate
+ * @brief
+ * Choose where to write a record of a given length inside a region : the least worn window,
+ * starting at the region or on a block. The wear of a window is the count of its hottest block,
+ * then the sum of the counts of its blocks between equal windows.
+ * @param
+ * start	:	First address of the region
+ * size		:	Size of the region
+ * length	:	Number of Bytes to be written
+ * @return
+ * uint32_t : Address of the window, start if the record does not fit in the region
+ */
+uint32_t WEAR_Allocate(uint32_t start, uint32_t size, uint32_t length)
+{
+	uint32_t best = start;
+	uint32_t bestMax = 0xFFFFFFFF;
+	uint32_t bestSum = 0xFFFFFFFF;
+	uint32_t addr = start;
+	uint32_t max, sum;
+
+	if(length == 0 || length > size)
+	{
+		return start;
+	}
+
+	while(addr + length <= start + size)
+	{
+		max = 0;
+		sum = 0;
+		for(uint32_t block = addr / WEAR_BLOCK_SIZE; block <= (addr + length - 1) / WEAR_BLOCK_SIZE && block < WEAR_NB_BLOCKS; block++)
+		{
+			if(WEAR_Table.count[block] > max)
+			{
+				max = WEAR_Table.count[block];
+			}
+			sum += WEAR_Table.count[block];
+		}
+
+		if(max < bestMax || (max == bestMax && sum < bestSum))
+		{
+			best = addr;
+			bestMax = max;
+			bestSum = sum;
+		}
+
+		//Next window on the next block
+		addr = (addr / WEAR_BLOCK_SIZE + 1) * WEAR_BLOCK_SIZE;
+	}
+
+	return best;
+}
+
+/*
+ * WEAR_isValid
+ * @brief
+ * Check the copy of the counters just read from a slot
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 if the slot holds a valid copy
+ */
+uint8_t WEAR_isValid(void)
+{
+	if(WEAR_Table.sequence == WEAR_EMPTY)
+	{
+		return 0;
+	}
+
+	return CRC32_Compute((uint8_t *)&WEAR_Table, offsetof(WEAR_Table_t, crc)) == WEAR_Table.crc;
+}
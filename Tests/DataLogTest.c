@@ -0,0 +1,384 @@
+/*
+ * DataLogTest.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * Host test of the sample log (DataLog, LogIndex) over an EEPROM simulated by StorageFile.
+ * The log is filled beyond its size, then read back after a reset by LOG_Export and LOG_Query.
+ * An append interrupted by a reset must not spoil the records already on its page, nor a step
+ * back of the clock the records written before and after it.
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include <stdio.h>
+#include "DataLog.h"
+#include "LogIndex.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define TEST_PATH				"DataLogTest.bin"
+#define TEST_RECORDS			50000		// Records appended, more than the log holds
+#define TEST_QUERY_T0			49000		// Time range of LOG_Query
+#define TEST_QUERY_T1			49999
+#define TEST_TORN				10			// Records on the page of the interrupted append
+#define TEST_STEP				100			// Records appended on each side of the step back of the clock
+#define TEST_STEP_TIME			5000		// Time after the step, older than all the records of the log
+#define TEST_CRC_CHECK			0x0376E6E7	// CRC-32/MPEG-2 of "123456789"
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+LOG_Config_t TEST_Config = {LOG_MODE_PERIODIC, LOG_DEFAULT_DEADBAND, LOG_DEFAULT_HEARTBEAT};
+uint32_t TEST_Count, TEST_First, TEST_Last, TEST_Gaps;
+uint32_t TEST_Tick = 0;
+uint32_t TEST_Steps;					// Records of TEST_ClockBack read in their order
+
+extern LOG_Ring_t LOG_RawRing;			// Ring of the sample log, to write an append interrupted at its head
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint8_t TEST_Crc(void);
+uint8_t TEST_Fill(const STO_Device_t * device);
+uint8_t TEST_Torn(const STO_Device_t * device);
+uint8_t TEST_ClockBack(const STO_Device_t * device);
+void TEST_Read(LOG_Record_t * record);
+void TEST_ReadStep(LOG_Record_t * record);
+void TEST_Reset(void);
+
+
+/***************************************************************************************/
+int main(void)
+{
+	const STO_Device_t * device;
+	uint8_t failed = 0;
+
+	remove(TEST_PATH);
+	device = STO_FileOpen(TEST_PATH, EE_SIZE_MEMORY, EE_SIZE_PAGE, STO_NO_ERASE);
+	if(device == NULL)
+	{
+		printf("DataLogTest : cannot open %s\n", TEST_PATH);
+		return 1;
+	}
+
+	failed |= TEST_Crc();
+	failed |= TEST_Fill(device);
+	failed |= TEST_Torn(device);
+	failed |= TEST_ClockBack(device);
+
+	STO_FileClose();
+	remove(TEST_PATH);
+
+	printf("DataLogTest : %s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Crc
+ * @brief
+ * Check the software CRC of the host against the check value of CRC-32/MPEG-2
+ * @param
+ * none
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_Crc(void)
+{
+	uint8_t check[] = "123456789";
+	uint32_t crc = CRC32_Compute(check, sizeof(check) - 1);
+
+	printf("DataLogTest : CRC 0x%08lX : %s\n", (unsigned long)crc, crc == TEST_CRC_CHECK ? "OK" : "FAILED");
+
+	return crc != TEST_CRC_CHECK;
+}
+
+/*
+ * TEST_Fill
+ * @brief
+ * Append TEST_RECORDS records, one per second, then initialize the log again and read it back.
+ * The export must end with the last record without any gap and hold all the full pages of
+ * the log, the query must give exactly its time range.
+ * @param
+ * device : Simulated EEPROM
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_Fill(const STO_Device_t * device)
+{
+	uint32_t pages = LOG_RAW_SIZE / EE_SIZE_PAGE;
+	uint32_t exported;
+	uint8_t failed = 0;
+
+	if(LOG_Init(TEST_Config, device) != HAL_OK)
+	{
+		printf("  init failed\n");
+		return 1;
+	}
+
+	for(uint32_t timestamp = 1; timestamp <= TEST_RECORDS; timestamp++)
+	{
+		if(LOG_Process(timestamp, LOG_CHANNEL_TEMPERATURE, timestamp & 0xFF) != HAL_OK)
+		{
+			printf("  append failed\n");
+			return 1;
+		}
+	}
+
+	//Reset
+	if(LOG_Init(TEST_Config, device) != HAL_OK)
+	{
+		printf("  init after reset failed\n");
+		return 1;
+	}
+
+	TEST_Reset();
+	LOG_Export(TEST_Read);
+	if(TEST_Gaps || TEST_Last != TEST_RECORDS || TEST_Count < (pages - 1) * LOG_RECORDS_PER_PAGE(LOG_RECORD_SIZE))
+	{
+		printf("  export : %lu records from %lu to %lu, %lu gaps\n",
+				(unsigned long)TEST_Count, (unsigned long)TEST_First, (unsigned long)TEST_Last, (unsigned long)TEST_Gaps);
+		failed = 1;
+	}
+	exported = TEST_Count;
+
+	TEST_Reset();
+	LOG_Query(TEST_QUERY_T0, TEST_QUERY_T1, TEST_Read);
+	if(TEST_Gaps || TEST_First != TEST_QUERY_T0 || TEST_Last != TEST_QUERY_T1)
+	{
+		printf("  query : %lu records from %lu to %lu, %lu gaps\n",
+				(unsigned long)TEST_Count, (unsigned long)TEST_First, (unsigned long)TEST_Last, (unsigned long)TEST_Gaps);
+		failed = 1;
+	}
+
+	if(LOG_getCrcErrors())
+	{
+		printf("  %lu pages with a wrong CRC\n", (unsigned long)LOG_getCrcErrors());
+		failed = 1;
+	}
+
+	printf("DataLogTest : %u records, %lu exported : %s\n", TEST_RECORDS, (unsigned long)exported, failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Torn
+ * @brief
+ * Start a new page with TEST_TORN records, then write only the first Bytes of the next one
+ * as a reset during the append would. After a new initialization, the records of the page
+ * must still be read back.
+ * @param
+ * device : Simulated EEPROM
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_Torn(const STO_Device_t * device)
+{
+	LOG_Record_t record;
+	uint32_t timestamp = TEST_RECORDS;
+	uint32_t first;
+	uint8_t failed = 0;
+
+	//Up to the start of a page, then the records of the page
+	do
+	{
+		timestamp++;
+		LOG_Process(timestamp, LOG_CHANNEL_TEMPERATURE, timestamp & 0xFF);
+	}
+	while((LOG_RawRing.head - LOG_RawRing.start) % EE_SIZE_PAGE);
+
+	first = timestamp + 1;
+	for(uint8_t k = 0; k < TEST_TORN; k++)
+	{
+		timestamp++;
+		LOG_Process(timestamp, LOG_CHANNEL_TEMPERATURE, timestamp & 0xFF);
+	}
+
+	//Reset while the next record is written : its channel and flags are not programmed
+	record.timestamp = timestamp + 1;
+	record.value = 0;
+	STO_Program(device, LOG_RawRing.head, (uint8_t *)&record, LOG_RECORD_SIZE - 2);
+
+	if(LOG_Init(TEST_Config, device) != HAL_OK)
+	{
+		printf("  init after reset failed\n");
+		return 1;
+	}
+
+	TEST_Reset();
+	LOG_Query(first, timestamp, TEST_Read);
+	if(TEST_Gaps || TEST_Count != TEST_TORN || LOG_getCrcErrors())
+	{
+		printf("  query : %lu records from %lu to %lu, %lu gaps, %lu pages with a wrong CRC\n",
+				(unsigned long)TEST_Count, (unsigned long)TEST_First, (unsigned long)TEST_Last,
+				(unsigned long)TEST_Gaps, (unsigned long)LOG_getCrcErrors());
+		failed = 1;
+	}
+
+	//The page is sealed once full, after the interrupted record
+	timestamp++;
+	for(uint8_t k = 0; k < LOG_RECORDS_PER_PAGE(LOG_RECORD_SIZE); k++)
+	{
+		timestamp++;
+		LOG_Process(timestamp, LOG_CHANNEL_TEMPERATURE, timestamp & 0xFF);
+	}
+	LOG_Init(TEST_Config, device);
+
+	TEST_Reset();
+	LOG_Query(first, first + TEST_TORN - 1, TEST_Read);
+	if(TEST_Count != TEST_TORN || LOG_getCrcErrors())
+	{
+		printf("  query after the seal : %lu records, %lu pages with a wrong CRC\n",
+				(unsigned long)TEST_Count, (unsigned long)LOG_getCrcErrors());
+		failed = 1;
+	}
+
+	printf("DataLogTest : interrupted append : %s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_ClockBack
+ * @brief
+ * Append TEST_STEP records, reset, set the clock back before all the records of the log and append
+ * TEST_STEP records again across a second reset. The records are numbered in their value on the channel
+ * LOG_CHANNEL_MCU_TEMP : the export must give all of them in the order of the writes, and the query
+ * of the time after the step all the records written since.
+ * @param
+ * device : Simulated EEPROM
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_ClockBack(const STO_Device_t * device)
+{
+	uint32_t timestamp = LOG_RawRing.last;
+	int16_t number = 0;
+	uint8_t failed = 0;
+
+	for(uint16_t k = 0; k < TEST_STEP; k++)
+	{
+		timestamp++;
+		number++;
+		LOG_Process(timestamp, LOG_CHANNEL_MCU_TEMP, number);
+	}
+	LOG_Init(TEST_Config, device);
+
+	//Step back, then a reset in the middle of the records written after it
+	timestamp = TEST_STEP_TIME;
+	for(uint16_t k = 0; k < TEST_STEP; k++)
+	{
+		if(k == TEST_STEP / 2)
+		{
+			LOG_Init(TEST_Config, device);
+		}
+		timestamp++;
+		number++;
+		LOG_Process(timestamp, LOG_CHANNEL_MCU_TEMP, number);
+	}
+
+	if(LOG_Init(TEST_Config, device) != HAL_OK)
+	{
+		printf("  init after reset failed\n");
+		return 1;
+	}
+
+	TEST_Steps = 0;
+	LOG_Export(TEST_ReadStep);
+	if(TEST_Steps != (uint32_t)number)
+	{
+		printf("  export : %lu records in order out of %d\n", (unsigned long)TEST_Steps, number);
+		failed = 1;
+	}
+
+	TEST_Steps = TEST_STEP;
+	LOG_Query(TEST_STEP_TIME + 1, timestamp, TEST_ReadStep);
+	if(TEST_Steps != (uint32_t)number)
+	{
+		printf("  query : %lu records in order out of %d\n", (unsigned long)(TEST_Steps - TEST_STEP), TEST_STEP);
+		failed = 1;
+	}
+
+	printf("DataLogTest : clock set back : %s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Read
+ * @brief
+ * Check that the records given by LOG_Export or LOG_Query follow each other
+ * @param
+ * record : Record read
+ * @return
+ * none
+ */
+void TEST_Read(LOG_Record_t * record)
+{
+	if(TEST_Count == 0)
+	{
+		TEST_First = record->timestamp;
+	}
+	else if(record->timestamp != TEST_Last + 1)
+	{
+		TEST_Gaps++;
+	}
+	TEST_Last = record->timestamp;
+	TEST_Count++;
+}
+
+/*
+ * TEST_ReadStep
+ * @brief
+ * Count the records of TEST_ClockBack given in the order of their number
+ * @param
+ * record : Record read
+ * @return
+ * none
+ */
+void TEST_ReadStep(LOG_Record_t * record)
+{
+	if(record->channel == LOG_CHANNEL_MCU_TEMP && record->value == (int16_t)(TEST_Steps + 1))
+	{
+		TEST_Steps++;
+	}
+}
+
+/*
+ * TEST_Reset
+ * @brief
+ * Clear the counters of TEST_Read
+ * @param
+ * none
+ * @return
+ * none
+ */
+void TEST_Reset(void)
+{
+	TEST_Count = 0;
+	TEST_First = 0;
+	TEST_Last = 0;
+	TEST_Gaps = 0;
+}
+
+/*
+ * HAL_GetTick
+ * @brief
+ * Time base of the timeouts of the drivers, one tick per call on the host
+ * @param
+ * none
+ * @return
+ * uint32_t : Tick
+ */
+uint32_t HAL_GetTick(void)
+{
+	return TEST_Tick++;
+}
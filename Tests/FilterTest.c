@@ -0,0 +1,115 @@
+/*
+ * FilterTest.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * Host test of the filters of the ADC stream (Filter) on known inputs.
+ * Each filter is primed with the first sample, then follows a step : the outputs are
+ * compared to the values computed by hand. The FIR filter is run on one channel of
+ * interleaved scans, the other channel must not be changed.
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include <stdio.h>
+#include "Filter.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define TEST_SAMPLES			8
+#define TEST_CHANNELS			2			// Interleaved channels of the FIR test
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+FLT_Filter_t TEST_Filter;
+
+//y[n] = 0.5.x[n] + 0.25.x[n-1] + 0.25.x[n-2], odd number of taps (Q15)
+const int16_t TEST_Fir[] = {16384, 8192, 8192};
+const uint16_t TEST_FirInput[TEST_SAMPLES] = {1000, 1000, 2000, 2000, 2000, 2000, 2000, 1000};
+const uint16_t TEST_FirOutput[TEST_SAMPLES] = {1000, 1000, 1500, 1750, 2000, 2000, 2000, 1500};
+
+//y[n] = 0.5.x[n] + 0.5.y[n-1], one section (Q14)
+const int16_t TEST_Iir[] = {8192, 0, 0, -8192, 0};
+const uint16_t TEST_IirInput[TEST_SAMPLES] = {1000, 2000, 2000, 2000, 2000, 2000, 2000, 2000};
+const uint16_t TEST_IirOutput[TEST_SAMPLES] = {1000, 1500, 1750, 1875, 1938, 1969, 1985, 1993};
+
+//Median of 5 : a single spike is removed, a step passes after 3 samples
+const uint16_t TEST_MedianInput[TEST_SAMPLES] = {100, 100, 5000, 100, 100, 200, 200, 200};
+const uint16_t TEST_MedianOutput[TEST_SAMPLES] = {100, 100, 100, 100, 100, 100, 200, 200};
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint8_t TEST_Run(const char * name, FLT_Config_t config, const uint16_t * input, const uint16_t * output);
+
+
+/***************************************************************************************/
+int main(void)
+{
+	FLT_Config_t fir = {FLT_FIR, 3, TEST_Fir};
+	FLT_Config_t iir = {FLT_IIR, 1, TEST_Iir};
+	FLT_Config_t median = {FLT_MEDIAN, 5, NULL};
+	uint8_t failed = 0;
+
+	failed |= TEST_Run("FIR", fir, TEST_FirInput, TEST_FirOutput);
+	failed |= TEST_Run("IIR", iir, TEST_IirInput, TEST_IirOutput);
+	failed |= TEST_Run("median", median, TEST_MedianInput, TEST_MedianOutput);
+
+	printf("FilterTest : %s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Run
+ * @brief
+ * Filter TEST_SAMPLES samples of the first of TEST_CHANNELS interleaved channels, in two blocks
+ * so that the state is carried from one block to the next, and check the outputs
+ * @param
+ * name		:	Name of the filter in the report
+ * config	:	Filter to test
+ * input	:	Samples of the channel
+ * output	:	Expected outputs
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_Run(const char * name, FLT_Config_t config, const uint16_t * input, const uint16_t * output)
+{
+	uint16_t samples[TEST_SAMPLES * TEST_CHANNELS];
+	uint8_t failed = 0;
+
+	if(FLT_Init(&TEST_Filter, config) != HAL_OK)
+	{
+		printf("  %s : init failed\n", name);
+		return 1;
+	}
+
+	for(uint8_t k = 0; k < TEST_SAMPLES; k++)
+	{
+		samples[k * TEST_CHANNELS] = input[k];
+		samples[k * TEST_CHANNELS + 1] = k;
+	}
+
+	FLT_Process(&TEST_Filter, samples, TEST_SAMPLES / 2, TEST_CHANNELS);
+	FLT_Process(&TEST_Filter, &samples[TEST_SAMPLES / 2 * TEST_CHANNELS], TEST_SAMPLES / 2, TEST_CHANNELS);
+
+	for(uint8_t k = 0; k < TEST_SAMPLES; k++)
+	{
+		if(samples[k * TEST_CHANNELS] != output[k] || samples[k * TEST_CHANNELS + 1] != k)
+		{
+			printf("  %s : sample %u is %u, expected %u\n", name, k, samples[k * TEST_CHANNELS], output[k]);
+			failed = 1;
+		}
+	}
+
+	printf("FilterTest : %s : %s\n", name, failed ? "FAILED" : "OK");
+
+	return failed;
+}
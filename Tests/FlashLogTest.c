@@ -0,0 +1,181 @@
+/*
+ * FlashLogTest.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: chevillard
+ */
+
+/*
+ * Host test of the log of a NOR flash (FlashLog) over the flash simulated by StorageFile.
+ * The records are appended as by the main loop, a few per wake of the RTC with one call of
+ * FLOG_Process, and the log is read back after a reset : no record may be dropped or reordered.
+ */
+
+/*
+ * INCLUDE FILES
+ */
+#include <stdio.h>
+#include "FlashLog.h"
+
+/*
+ * PRIVATE CONSTANTS
+ */
+#define TEST_PATH				"FlashLogTest.bin"
+#define TEST_SIZE				0x10000		// Simulated NOR flash (64 KB)
+#define TEST_PAGE				0x100
+#define TEST_SECTOR				0x1000
+#define TEST_LENGTH				8			// Size of one record
+#define TEST_QUEUE				64			// Records of the queue (see NOR_QUEUE_RECORDS)
+#define TEST_PER_WAKE			2			// Records appended between two calls of FLOG_Process
+
+/*
+ * PRIVATE GLOBAL VARIABLES
+ */
+FLOG_Log_t TEST_Log;
+uint8_t TEST_Queue[TEST_QUEUE * TEST_LENGTH];
+uint32_t TEST_Tick = 0;
+uint32_t TEST_Count, TEST_Last, TEST_Gaps;
+
+
+/*
+ * PRIVATE FUNCTION PROTOTYPES
+ */
+uint8_t TEST_Run(const STO_Device_t * device, uint32_t records);
+void TEST_Visitor(uint8_t * record);
+
+
+/***************************************************************************************/
+int main(void)
+{
+	const STO_Device_t * device;
+	uint8_t failed = 0;
+
+	remove(TEST_PATH);
+	device = STO_FileOpen(TEST_PATH, TEST_SIZE, TEST_PAGE, TEST_SECTOR);
+	if(device == NULL)
+	{
+		printf("FlashLogTest : cannot open %s\n", TEST_PATH);
+		return 1;
+	}
+
+	//Less than the log, then enough records to go around it several times
+	failed |= TEST_Run(device, 2000);
+	failed |= TEST_Run(device, 40000);
+
+	STO_FileClose();
+	remove(TEST_PATH);
+
+	printf("FlashLogTest : %s\n", failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Run
+ * @brief
+ * Append records with increasing timestamps, TEST_PER_WAKE per call of FLOG_Process, then
+ * initialize the log again and read it back. The records must end with the last one appended,
+ * without any gap, and none may be dropped by the queue.
+ * @param
+ * device	:	Simulated flash
+ * records	:	Number of records to append
+ * @return
+ * uint8_t : 1 if the test failed
+ */
+uint8_t TEST_Run(const STO_Device_t * device, uint32_t records)
+{
+	static uint32_t timestamp = 0;
+	uint8_t record[TEST_LENGTH];
+	uint32_t capacity;
+	uint8_t failed = 0;
+
+	if(FLOG_Init(&TEST_Log, device, 0, TEST_SIZE, TEST_LENGTH, TEST_Queue, TEST_QUEUE) != HAL_OK)
+	{
+		printf("  init failed\n");
+		return 1;
+	}
+
+	for(uint32_t k = 0; k < records; k++)
+	{
+		timestamp++;
+		memcpy(record, &timestamp, sizeof(timestamp));
+		memset(&record[sizeof(timestamp)], timestamp & 0xFF, TEST_LENGTH - sizeof(timestamp));
+		FLOG_Append(&TEST_Log, record);
+
+		if((k + 1) % TEST_PER_WAKE == 0 && FLOG_Process(&TEST_Log) != HAL_OK)
+		{
+			printf("  process failed\n");
+			failed = 1;
+		}
+	}
+	if(FLOG_Flush(&TEST_Log) != HAL_OK)
+	{
+		printf("  flush failed\n");
+		failed = 1;
+	}
+	if(TEST_Log.dropped)
+	{
+		printf("  %lu records dropped by the queue\n", (unsigned long)TEST_Log.dropped);
+		failed = 1;
+	}
+
+	//Reset
+	FLOG_Init(&TEST_Log, device, 0, TEST_SIZE, TEST_LENGTH, TEST_Queue, TEST_QUEUE);
+	TEST_Count = 0;
+	TEST_Gaps = 0;
+	FLOG_Export(&TEST_Log, TEST_Visitor);
+
+	//All the records are still there while they fit in the sectors which are not erased ahead
+	capacity = (TEST_SIZE / TEST_SECTOR - FLOG_ERASE_AHEAD - 1) * FLOG_RECORDS_PER_SECTOR(&TEST_Log);
+	if(TEST_Gaps || TEST_Last != timestamp || (timestamp <= capacity && TEST_Count != timestamp))
+	{
+		printf("  export : %lu records up to %lu, %lu gaps (last appended %lu)\n",
+				(unsigned long)TEST_Count, (unsigned long)TEST_Last, (unsigned long)TEST_Gaps, (unsigned long)timestamp);
+		failed = 1;
+	}
+	if(STO_FileGetErrors())
+	{
+		printf("  %lu misuses of the flash\n", (unsigned long)STO_FileGetErrors());
+		failed = 1;
+	}
+
+	printf("FlashLogTest : %lu records, %lu read back : %s\n", (unsigned long)records, (unsigned long)TEST_Count, failed ? "FAILED" : "OK");
+
+	return failed;
+}
+
+/*
+ * TEST_Visitor
+ * @brief
+ * Check that the records read by FLOG_Export follow each other
+ * @param
+ * record : Record read
+ * @return
+ * none
+ */
+void TEST_Visitor(uint8_t * record)
+{
+	uint32_t timestamp;
+
+	memcpy(&timestamp, record, sizeof(timestamp));
+	if(TEST_Count && timestamp != TEST_Last + 1)
+	{
+		TEST_Gaps++;
+	}
+	TEST_Last = timestamp;
+	TEST_Count++;
+}
+
+/*
+ * HAL_GetTick
+ * @brief
+ * Time base of the timeouts of the drivers, one tick per call on the host
+ * @param
+ * none
+ * @return
+ * uint32_t : Tick
+ */
+uint32_t HAL_GetTick(void)
+{
+	return TEST_Tick++;
+}